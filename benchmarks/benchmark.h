@@ -0,0 +1,45 @@
+#pragma once
+
+#include <chrono>
+#include <cstring>
+
+// Minimal timing helpers shared by the benchmarks.
+
+// Benchmarks take `--quick` when run from ctest, to keep the test run short.
+inline bool IsQuickRun(int argc, char** argv)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--quick") == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Runs fn `iterations` times and returns the average duration of a call, in nanoseconds.
+// fn takes the iteration index so that it can vary its input.
+template <typename Fn>
+double MeasureNanosecondsPerCall(size_t iterations, Fn&& fn)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        fn(i);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(iterations);
+}
+
+// Keeps the compiler from optimizing away a computed value.
+template <typename T>
+void DoNotOptimize(T const& value)
+{
+#if defined(_MSC_VER)
+    static char const volatile* sink;
+    sink = reinterpret_cast<char const volatile*>(&value);
+#else
+    asm volatile("" : : "g"(&value) : "memory");
+#endif
+}
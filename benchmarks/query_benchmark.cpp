@@ -0,0 +1,116 @@
+#include "window_query.h"
+
+#include "benchmark.h"
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+// Per-keystroke cost of QueryWindows on 10k windows, with and without typo-tolerant matching.
+// Every prefix of each query is run, the way the overlay queries again on every EN_CHANGE.
+
+namespace
+{
+    std::vector<window_process_info> MakeWindows(size_t count)
+    {
+        char const* words[] = {
+            "report", "budget", "meeting", "notes", "inbox", "draft", "readme", "main", "index", "project",
+            "design", "review", "invoice", "summary", "calendar", "photos", "music", "settings", "debug", "release",
+            "Quarterly", "Planning", "WindowSwitcher", "QueryWindows", "v141", "2018", "final", "backup", "todo", "issue" };
+        char const* applications[][2] = {
+            { "Google Chrome", "chrome.exe" }, { "Outlook", "outlook.exe" }, { "Microsoft Visual Studio", "devenv.exe" },
+            { "Notepad++", "notepad++.exe" }, { "Microsoft Word", "winword.exe" }, { "Microsoft Excel", "excel.exe" },
+            { "File Explorer", "explorer.exe" }, { "Slack", "slack.exe" }, { "Spotify", "spotify.exe" }, { "Paint", "mspaint.exe" } };
+
+        std::mt19937 random(42);
+        std::vector<window_process_info> wpis;
+        wpis.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            std::string title;
+            auto word_count = 2 + random() % 5;
+            for (size_t w = 0; w < word_count; ++w)
+            {
+                title += words[random() % (sizeof(words) / sizeof(words[0]))];
+                title += w + 1 < word_count ? " " : ".txt";
+            }
+            auto const& application = applications[random() % (sizeof(applications) / sizeof(applications[0]))];
+            title += " - ";
+            title += application[0];
+            wpis.emplace_back(nullptr, static_cast<uint32_t>(i), std::move(title), std::string(application[1]));
+        }
+        return wpis;
+    }
+
+    // Average time to run QueryWindows on every prefix of every query, i.e. per keystroke.
+    double MeasureNanosecondsPerKeystroke(std::vector<window_process_info> const& wpis, std::vector<std::string> const& queries, bool allow_typos, size_t repetitions)
+    {
+        std::vector<std::string> keystrokes;
+        for (auto const& query : queries)
+        {
+            for (size_t length = 1; length <= query.size(); ++length)
+            {
+                keystrokes.push_back(query.substr(0, length));
+            }
+        }
+
+        return MeasureNanosecondsPerCall(keystrokes.size() * repetitions, [&](size_t i)
+        {
+            std::vector<size_t> matching_indices;
+            QueryWindows(keystrokes[i % keystrokes.size()], wpis, matching_indices, allow_typos);
+            DoNotOptimize(matching_indices);
+        });
+    }
+}
+
+int main(int argc, char** argv)
+{
+    bool const is_quick = IsQuickRun(argc, argv);
+    size_t const repetitions = is_quick ? 1 : 10;
+    auto const wpis = MakeWindows(10000);
+
+    struct
+    {
+        char const* name;
+        std::vector<std::string> queries;
+    } const workloads[] = {
+        { "correctly typed", { "chrome", "outlook", "visual studio", "readme", "budget report" } },
+        { "mistyped", { "chrmoe", "outlok", "visaul studoi", "raedme", "budgte reprot" } },
+    };
+
+    // The typo-tolerant path is only measured if the mistyped queries actually match, rather than being
+    // rejected by the prefilters.
+    for (auto const& workload : workloads)
+    {
+        for (auto const& query : workload.queries)
+        {
+            std::vector<size_t> matching_indices;
+            QueryWindows(query, wpis, matching_indices, true);
+            if (matching_indices.empty())
+            {
+                std::printf("\"%s\" matches no window.\n", query.c_str());
+                return 1;
+            }
+        }
+    }
+
+    double worst_ratio = 0;
+    for (auto const& workload : workloads)
+    {
+        auto exact_ns = MeasureNanosecondsPerKeystroke(wpis, workload.queries, false, repetitions);
+        auto approximate_ns = MeasureNanosecondsPerKeystroke(wpis, workload.queries, true, repetitions);
+        auto ratio = approximate_ns / exact_ns;
+        worst_ratio = std::max(worst_ratio, ratio);
+        std::printf("%-16s exact %8.1f us/keystroke, with typos %8.1f us/keystroke, ratio %.2fx\n",
+            workload.name, exact_ns / 1000.0, approximate_ns / 1000.0, ratio);
+    }
+
+    // Timings of the short ctest run are too noisy to enforce the budget.
+    if (!is_quick && worst_ratio > 2.0)
+    {
+        std::printf("Typo-tolerant matching costs more than 2x exact matching.\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,133 @@
+#include "word_index.h"
+
+#include "benchmark.h"
+
+#include <cctype>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+// Per-keystroke cost of word start and acronym matching on 10k window titles:
+// - with the word indices computed once per snapshot, as QueryWindows does,
+// - with word boundaries detected again on every keystroke, in a single pass over each title.
+
+namespace
+{
+    std::vector<std::string> MakeTitles(size_t count)
+    {
+        char const* words[] = {
+            "report", "budget", "meeting", "notes", "inbox", "draft", "readme", "main", "index", "project",
+            "Quarterly", "Planning", "WindowSwitcher", "QueryWindows", "v141", "2018", "final", "backup", "VSCode", "HTML" };
+        char const* applications[] = {
+            "Google Chrome", "Outlook", "Microsoft Visual Studio", "Notepad++", "Microsoft Word", "File Explorer" };
+
+        std::mt19937 random(42);
+        std::vector<std::string> titles;
+        for (size_t i = 0; i < count; ++i)
+        {
+            std::string title;
+            auto word_count = 2 + random() % 5;
+            for (size_t w = 0; w < word_count; ++w)
+            {
+                title += words[random() % (sizeof(words) / sizeof(words[0]))];
+                title += w + 1 < word_count ? " " : ".txt";
+            }
+            title += " - ";
+            title += applications[random() % (sizeof(applications) / sizeof(applications[0]))];
+            titles.push_back(std::move(title));
+        }
+        return titles;
+    }
+
+    // Word start and acronym matching without an index: one pass over the title, comparing the query at every
+    // word start and collecting the initials as it goes. acronym is reused from title to title.
+    bool MatchesInSinglePass(std::string const& title, std::string const& lowercase_query, std::string& acronym)
+    {
+        acronym.clear();
+        for (size_t i = 0; i < title.size(); ++i)
+        {
+            if (!IsWordStart(title, i))
+            {
+                continue;
+            }
+            acronym.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(title[i]))));
+
+            size_t length = 0;
+            while (length < lowercase_query.size() && i + length < title.size() &&
+                std::tolower(static_cast<unsigned char>(title[i + length])) == static_cast<unsigned char>(lowercase_query[length]))
+            {
+                ++length;
+            }
+            if (!lowercase_query.empty() && length == lowercase_query.size())
+            {
+                return true;
+            }
+        }
+        return lowercase_query.size() > 1 && acronym.find(lowercase_query) != std::string::npos;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    bool const is_quick = IsQuickRun(argc, argv);
+    size_t const repetitions = is_quick ? 1 : 10;
+    auto const titles = MakeTitles(10000);
+
+    std::vector<word_index> indices;
+    for (auto const& title : titles)
+    {
+        indices.push_back(BuildWordIndex(title));
+    }
+
+    std::vector<std::string> keystrokes;
+    for (std::string query : { "visual studio", "readme", "vsc", "quarterly", "ws" })
+    {
+        for (size_t length = 1; length <= query.size(); ++length)
+        {
+            keystrokes.push_back(query.substr(0, length));
+        }
+    }
+    size_t const iterations = keystrokes.size() * repetitions;
+
+    auto precomputed_ns = MeasureNanosecondsPerCall(iterations, [&](size_t i)
+    {
+        auto const& query = keystrokes[i % keystrokes.size()];
+        size_t match_count = 0;
+        for (auto const& index : indices)
+        {
+            match_count += MatchesWordPrefix(index, query) || MatchesAcronym(index, query);
+        }
+        DoNotOptimize(match_count);
+    });
+
+    std::string acronym;
+    auto single_pass_ns = MeasureNanosecondsPerCall(iterations, [&](size_t i)
+    {
+        auto const& query = keystrokes[i % keystrokes.size()];
+        size_t match_count = 0;
+        for (auto const& title : titles)
+        {
+            match_count += MatchesInSinglePass(title, query, acronym);
+        }
+        DoNotOptimize(match_count);
+    });
+
+    // Both must find the same windows, or the comparison is meaningless.
+    for (auto const& query : keystrokes)
+    {
+        for (size_t t = 0; t < titles.size(); ++t)
+        {
+            bool precomputed = MatchesWordPrefix(indices[t], query) || MatchesAcronym(indices[t], query);
+            if (precomputed != MatchesInSinglePass(titles[t], query, acronym))
+            {
+                std::printf("Mismatch for \"%s\" in \"%s\"\n", query.c_str(), titles[t].c_str());
+                return 1;
+            }
+        }
+    }
+
+    std::printf("%-30s %8.1f us/keystroke\n", "precomputed", precomputed_ns / 1000.0);
+    std::printf("%-30s %8.1f us/keystroke\n", "single pass on every keystroke", single_pass_ns / 1000.0);
+    return 0;
+}
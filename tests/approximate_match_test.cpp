@@ -0,0 +1,145 @@
+#include "approximate_match.h"
+
+#include "check.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // Reference implementation: smallest edit distance between the pattern and any substring of text, where
+    // swapping two adjacent characters is one edit (Sellers' dynamic programming, with the transposition case of
+    // the optimal string alignment distance).
+    int BruteForceSubstringDistance(std::string const& pattern, std::string const& text)
+    {
+        std::vector<int> two_back(pattern.size() + 1);
+        std::vector<int> previous(pattern.size() + 1);
+        std::vector<int> current(pattern.size() + 1);
+        for (size_t i = 0; i <= pattern.size(); ++i)
+        {
+            previous[i] = static_cast<int>(i);
+        }
+        int best = previous[pattern.size()];
+        for (size_t j = 0; j < text.size(); ++j)
+        {
+            char c = text[j];
+            current[0] = 0;
+            for (size_t i = 1; i <= pattern.size(); ++i)
+            {
+                current[i] = std::min({ previous[i] + 1, current[i - 1] + 1, previous[i - 1] + (pattern[i - 1] != c ? 1 : 0) });
+                if (i > 1 && j > 0 && pattern[i - 1] == text[j - 1] && pattern[i - 2] == c)
+                {
+                    current[i] = std::min(current[i], two_back[i - 2] + 1);
+                }
+            }
+            best = std::min(best, current[pattern.size()]);
+            std::swap(two_back, previous);
+            std::swap(previous, current);
+        }
+        return best;
+    }
+
+    void TestAgainstBruteForce()
+    {
+        std::mt19937 random(1);
+        for (int iteration = 0; iteration < 200000; ++iteration)
+        {
+            // A small alphabet makes near matches frequent.
+            std::string pattern(1 + random() % 8, ' ');
+            std::string text(random() % 16, ' ');
+            for (auto& c : pattern)
+            {
+                c = static_cast<char>('a' + random() % 3);
+            }
+            for (auto& c : text)
+            {
+                c = static_cast<char>('a' + random() % 3);
+            }
+            int max_edits = static_cast<int>(random() % (c_MAX_APPROXIMATE_EDITS + 1));
+
+            // The matcher never allows as many edits as there are pattern characters.
+            int allowed_edits = std::min(max_edits, static_cast<int>(pattern.size()) - 1);
+            int distance = BruteForceSubstringDistance(pattern, text);
+            int expected = distance <= allowed_edits ? distance : -1;
+            int actual = ApproximateFind(BuildBitapPattern(pattern), text, max_edits);
+            CHECK_EQ(actual, expected);
+            if (actual != expected)
+            {
+                std::fprintf(stderr, "  pattern \"%s\", text \"%s\", max_edits %d\n", pattern.c_str(), text.c_str(), max_edits);
+                return;
+            }
+
+            // The character set filter must never rule out a text that matches.
+            if (expected >= 0)
+            {
+                CHECK(MightMatchApproximately(pattern, BuildCharacterSet(text), max_edits));
+                CHECK(ContainsAnyPatternPiece(pattern, text, BuildBigramSet(text), allowed_edits));
+            }
+        }
+    }
+
+    void TestLongestPattern()
+    {
+        std::string pattern(c_MAX_APPROXIMATE_PATTERN_LENGTH, 'a');
+        std::string text = "xx" + pattern + "yy";
+        CHECK_EQ(ApproximateFind(BuildBitapPattern(pattern), text, 2), 0);
+        text[10] = 'b';
+        CHECK_EQ(ApproximateFind(BuildBitapPattern(pattern), text, 2), 1);
+    }
+
+    void TestTypos()
+    {
+        // Two adjacent letters swapped: one edit, anywhere in the word.
+        CHECK_EQ(ApproximateFind(BuildBitapPattern("chrmoe"), "chrome.exe", MaxEditsForQueryLength(6)), 1);
+        CHECK_EQ(ApproximateFind(BuildBitapPattern("raedme"), "readme.md", MaxEditsForQueryLength(6)), 1);
+        CHECK_EQ(ApproximateFind(BuildBitapPattern("hcrome"), "chrome.exe", MaxEditsForQueryLength(6)), 1);
+        CHECK_EQ(ApproximateFind(BuildBitapPattern("chroem"), "chrome.exe", MaxEditsForQueryLength(6)), 1);
+        CHECK_EQ(ApproximateFind(BuildBitapPattern("chrmoe"), "chrome.exe", 0), -1);
+        // Two swaps are two edits.
+        CHECK_EQ(ApproximateFind(BuildBitapPattern("hcrmoe"), "chrome.exe", MaxEditsForQueryLength(6)), -1);
+        CHECK_EQ(ApproximateFind(BuildBitapPattern("hcrmoe"), "chrome.exe", 2), 2);
+        // Missing letter: one deletion.
+        CHECK_EQ(ApproximateFind(BuildBitapPattern("outlok"), "outlook.exe", MaxEditsForQueryLength(6)), 1);
+        CHECK_EQ(ApproximateFind(BuildBitapPattern("notepda"), "notepad++.exe", MaxEditsForQueryLength(7)), 1);
+        CHECK_EQ(ApproximateFind(BuildBitapPattern("explorer"), "explorer.exe", 2), 0);
+        CHECK_EQ(ApproximateFind(BuildBitapPattern(""), "anything", 2), 0);
+    }
+
+    void TestEditPolicy()
+    {
+        CHECK_EQ(MaxEditsForQueryLength(2), 0);
+        CHECK_EQ(MaxEditsForQueryLength(3), 1);
+        CHECK_EQ(MaxEditsForQueryLength(7), 1);
+        CHECK_EQ(MaxEditsForQueryLength(8), 2);
+        CHECK_EQ(MaxEditsForQueryLength(c_MAX_APPROXIMATE_PATTERN_LENGTH), c_MAX_APPROXIMATE_EDITS);
+    }
+
+    void TestCharacterSetFilter()
+    {
+        auto characters = BuildCharacterSet("outlook.exe");
+        CHECK(MightMatchApproximately("outlok", characters, 1));
+        CHECK(MightMatchApproximately("outlxk", characters, 1));
+        CHECK(!MightMatchApproximately("ovtlzk", characters, 1));
+        CHECK(!MightMatchApproximately("zz", characters, 1));
+
+        CHECK(ContainsAnyPatternPiece("outlxx", "outlook.exe", BuildBigramSet("outlook.exe"), 1));
+        CHECK(ContainsAnyPatternPiece("xxtlook", "outlook.exe", BuildBigramSet("outlook.exe"), 1));
+        CHECK(!ContainsAnyPatternPiece("oxtlxok", "outlook.exe", BuildBigramSet("outlook.exe"), 1));
+        CHECK(ContainsAnyPatternPiece("oxtlxok", "outlook.exe", BuildBigramSet("outlook.exe"), 2));
+
+        // A swap across two pieces changes both of them.
+        CHECK_EQ(ApproximateFind(BuildBitapPattern("abdcef"), "abcdef", 1), 1);
+        CHECK(ContainsAnyPatternPiece("abdcef", "abcdef", BuildBigramSet("abcdef"), 1));
+    }
+}
+
+int main()
+{
+    TestAgainstBruteForce();
+    TestLongestPattern();
+    TestTypos();
+    TestEditPolicy();
+    TestCharacterSetFilter();
+    return ReportTestResult();
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdio>
+
+// Minimal assertion helpers shared by the tests. A failed CHECK is reported and the test keeps going,
+// ReportTestResult gives the exit code.
+
+inline int& TestFailureCount()
+{
+    static int failure_count = 0;
+    return failure_count;
+}
+
+#define CHECK(condition) \
+    do \
+    { \
+        if (!(condition)) \
+        { \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition); \
+            ++TestFailureCount(); \
+        } \
+    } while (false)
+
+#define CHECK_EQ(actual, expected) \
+    do \
+    { \
+        auto const& actual_value = (actual); \
+        auto const& expected_value = (expected); \
+        if (!(actual_value == expected_value)) \
+        { \
+            std::fprintf(stderr, "%s:%d: CHECK_EQ failed: %s == %s\n", __FILE__, __LINE__, #actual, #expected); \
+            ++TestFailureCount(); \
+        } \
+    } while (false)
+
+inline int ReportTestResult()
+{
+    if (TestFailureCount() == 0)
+    {
+        std::printf("All checks passed.\n");
+        return 0;
+    }
+    std::fprintf(stderr, "%d check(s) failed.\n", TestFailureCount());
+    return 1;
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "window_backend.h"
+
+// Bytes currently allocated with operator new. Defined by the test, which replaces the global operator new and
+// operator delete to count them.
+uint64_t AllocatedBytes();
+
+// Threads of the current process, 0 where it can't be read.
+inline uint64_t ReadThreadCount()
+{
+#ifdef __linux__
+    std::ifstream status("/proc/self/status");
+    std::string field;
+    while (status >> field)
+    {
+        if (field == "Threads:")
+        {
+            uint64_t thread_count = 0;
+            status >> thread_count;
+            return thread_count;
+        }
+    }
+#endif
+    return 0;
+}
+
+// Resources the fake forgets to release, to check that the soak test notices.
+struct fake_leaks
+{
+    // Leaks happen every |interval| overlays. 0 never leaks.
+    size_t interval = 0;
+
+    // Amount leaked each time.
+    uint64_t process_handles = 0;
+    uint64_t windows = 0;
+    uint64_t thumbnails = 0;
+    uint64_t threads = 0;
+    uint64_t memory_bytes = 0;
+};
+
+// Backend without any real window. Windows are numbered handles with made up titles. The fake counts what a Win32
+// backend would hold: process handles while reading window information, four windows per overlay, and thumbnails.
+struct fake_window_backend : window_backend
+{
+    explicit fake_window_backend(std::vector<std::string> titles, fake_leaks leaks = fake_leaks())
+        : titles(std::move(titles)), leaks(leaks)
+    {
+    }
+
+    ~fake_window_backend() override
+    {
+        {
+            std::lock_guard<std::mutex> lock(leaked_threads_mutex);
+            release_leaked_threads = true;
+        }
+        leaked_threads_released.notify_all();
+        for (auto& thread : leaked_threads)
+        {
+            thread.join();
+        }
+    }
+
+    std::vector<window_handle> GetVisibleWindows() override
+    {
+        std::vector<window_handle> hwnds;
+        for (size_t i = 0; i < titles.size(); ++i)
+        {
+            hwnds.push_back(reinterpret_cast<window_handle>(i + 1));
+        }
+        return hwnds;
+    }
+
+    std::vector<window_process_info> PopulateWindowInformation(std::vector<window_handle> const& hwnds) override
+    {
+        std::vector<window_process_info> wpis;
+        for (auto hwnd : hwnds)
+        {
+            auto index = reinterpret_cast<uintptr_t>(hwnd) - 1;
+            ++open_process_handles;
+            auto const& title = titles[index];
+            wpis.emplace_back(hwnd, static_cast<uint32_t>(index + 100), std::string(title), title.substr(0, title.find(' ')) + ".exe");
+            --open_process_handles;
+        }
+        return wpis;
+    }
+
+    void CreateOverlay() override
+    {
+        // Overlay, edit, list box and mirror.
+        open_windows += 4;
+    }
+
+    void DisplayWindowList(
+        std::vector<window_process_info> const& wpis,
+        std::vector<size_t> const& matching_indices,
+        bool is_query_empty) override
+    {
+        displayed_window_count = is_query_empty ? wpis.size() : matching_indices.size();
+    }
+
+    void RegisterThumbnail(window_handle /*source*/) override
+    {
+        has_thumbnail = true;
+    }
+
+    void CloseOverlay() override
+    {
+        open_windows -= 4;
+        has_thumbnail = false;
+
+        ++closed_overlay_count;
+        if (leaks.interval && closed_overlay_count % leaks.interval == 0)
+        {
+            Leak();
+        }
+    }
+
+    resource_usage ReadResourceUsage() override
+    {
+        resource_usage usage;
+        usage.memory_bytes = AllocatedBytes();
+        usage.handles = open_process_handles;
+        usage.gui_objects = open_windows + leaked_thumbnails + (has_thumbnail ? 1 : 0);
+        usage.threads = ReadThreadCount();
+        return usage;
+    }
+
+    void Leak()
+    {
+        open_process_handles += leaks.process_handles;
+        open_windows += leaks.windows;
+        leaked_thumbnails += leaks.thumbnails;
+        if (leaks.memory_bytes)
+        {
+            leaked_memory.emplace_back(new char[leaks.memory_bytes]);
+        }
+        for (uint64_t i = 0; i < leaks.threads; ++i)
+        {
+            leaked_threads.emplace_back([this]
+            {
+                std::unique_lock<std::mutex> lock(leaked_threads_mutex);
+                leaked_threads_released.wait(lock, [this] { return release_leaked_threads; });
+            });
+        }
+    }
+
+    std::vector<std::string> titles;
+    fake_leaks leaks;
+
+    // Only touched by the overlay thread, or after it was joined.
+    uint64_t open_process_handles = 0;
+    uint64_t open_windows = 0;
+    bool has_thumbnail = false;
+    uint64_t leaked_thumbnails = 0;
+    size_t closed_overlay_count = 0;
+    size_t displayed_window_count = 0;
+
+    // Released when the fake is destroyed, so that leaks don't outlive the test case.
+    std::vector<std::unique_ptr<char[]>> leaked_memory;
+    std::vector<std::thread> leaked_threads;
+    std::mutex leaked_threads_mutex;
+    std::condition_variable leaked_threads_released;
+    bool release_leaked_threads = false;
+};
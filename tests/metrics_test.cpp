@@ -0,0 +1,184 @@
+#include "metrics.h"
+
+#include "check.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    void TestBucketEdges()
+    {
+        // One bucket per value below c_HISTOGRAM_SUB_BUCKETS.
+        for (uint64_t value = 0; value < c_HISTOGRAM_SUB_BUCKETS; ++value)
+        {
+            CHECK_EQ(HistogramBucketIndex(value), static_cast<size_t>(value));
+        }
+
+        // Then c_HISTOGRAM_SUB_BUCKETS buckets per power of two.
+        CHECK_EQ(HistogramBucketIndex(8), size_t(8));
+        CHECK_EQ(HistogramBucketIndex(15), size_t(15));
+        CHECK_EQ(HistogramBucketIndex(16), size_t(16));
+        CHECK_EQ(HistogramBucketIndex(17), size_t(16));
+        CHECK_EQ(HistogramBucketIndex(18), size_t(17));
+        CHECK_EQ(HistogramBucketUpperBound(16), uint64_t(17));
+
+        // Last regular bucket, then overflow.
+        uint64_t const largest_tracked = (uint64_t(1) << c_HISTOGRAM_MAX_EXPONENT) - 1;
+        CHECK_EQ(c_HISTOGRAM_BUCKET_COUNT, size_t(305));
+        CHECK_EQ(HistogramBucketIndex(largest_tracked), c_HISTOGRAM_OVERFLOW_BUCKET - 1);
+        CHECK_EQ(HistogramBucketUpperBound(c_HISTOGRAM_OVERFLOW_BUCKET - 1), largest_tracked);
+        CHECK_EQ(HistogramBucketIndex(largest_tracked + 1), c_HISTOGRAM_OVERFLOW_BUCKET);
+        CHECK_EQ(HistogramBucketIndex((uint64_t(1) << 41) - 1), c_HISTOGRAM_OVERFLOW_BUCKET);
+        CHECK_EQ(HistogramBucketIndex(UINT64_MAX), c_HISTOGRAM_OVERFLOW_BUCKET);
+        CHECK_EQ(HistogramBucketUpperBound(c_HISTOGRAM_OVERFLOW_BUCKET), UINT64_MAX);
+
+        // Every regular bucket starts right after the previous one ends.
+        for (size_t i = 0; i + 1 < c_HISTOGRAM_OVERFLOW_BUCKET; ++i)
+        {
+            auto upper_bound = HistogramBucketUpperBound(i);
+            CHECK_EQ(HistogramBucketIndex(upper_bound), i);
+            CHECK_EQ(HistogramBucketIndex(upper_bound + 1), i + 1);
+        }
+    }
+
+    void TestPercentiles()
+    {
+        static histogram h;
+        CHECK_EQ(HistogramPercentile(h, 50), uint64_t(0));
+
+        for (uint64_t value = 1; value <= 1000; ++value)
+        {
+            RecordValue(h, value);
+        }
+        CHECK_EQ(h.count.load(), uint64_t(1000));
+        CHECK_EQ(h.sum.load(), uint64_t(500500));
+        CHECK_EQ(h.max_value.load(), uint64_t(1000));
+
+        // Percentiles are bucket upper bounds, within the bucket precision of the exact value.
+        auto p50 = HistogramPercentile(h, 50);
+        CHECK(p50 >= 500 && p50 <= 500 + 500 / c_HISTOGRAM_SUB_BUCKETS);
+        CHECK_EQ(HistogramPercentile(h, 100), uint64_t(1000));
+    }
+
+    void TestOverflowIsReportedAsInfinity()
+    {
+        static metrics_registry metrics;
+        RecordValue(metrics.query_windows, 5);
+        RecordValue(metrics.query_windows, uint64_t(1) << 50);
+
+        auto output = FormatMetrics(metrics);
+        CHECK(output.find("window_switcher_query_windows_microseconds_bucket{le=\"5\"} 1\n") != std::string::npos);
+        CHECK(output.find("window_switcher_query_windows_microseconds_bucket{le=\"+Inf\"} 2\n") != std::string::npos);
+        CHECK(output.find("window_switcher_query_windows_microseconds_bucket{le=\"18446744073709551615\"}") == std::string::npos);
+        CHECK(output.find("window_switcher_query_windows_microseconds_count 2\n") != std::string::npos);
+        CHECK_EQ(HistogramPercentile(metrics.query_windows, 100), uint64_t(1) << 50);
+    }
+
+    void TestConcurrentRecording()
+    {
+        static metrics_registry metrics;
+        constexpr int thread_count = 4;
+        constexpr uint64_t records_per_thread = 100000;
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < thread_count; ++t)
+        {
+            threads.emplace_back([]
+            {
+                for (uint64_t i = 0; i < records_per_thread; ++i)
+                {
+                    RecordValue(metrics.enumerate_windows, i);
+                    IncrementCounter(metrics.overlays_opened);
+                }
+            });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        uint64_t bucket_total = 0;
+        for (auto const& bucket : metrics.enumerate_windows.buckets)
+        {
+            bucket_total += bucket.load();
+        }
+        CHECK_EQ(bucket_total, thread_count * records_per_thread);
+        CHECK_EQ(metrics.enumerate_windows.count.load(), thread_count * records_per_thread);
+        CHECK_EQ(metrics.enumerate_windows.max_value.load(), records_per_thread - 1);
+        CHECK_EQ(metrics.overlays_opened.value.load(), thread_count * records_per_thread);
+    }
+
+    bool EndsWith(std::string const& text, std::string const& suffix)
+    {
+        return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    // The longest metric name must come out whole, and every line must be a comment or a sample.
+    void TestExpositionFormat()
+    {
+        static metrics_registry metrics;
+        RecordValue(metrics.populate_window_information, 1234);
+        IncrementCounter(metrics.windows_activated);
+
+        auto output = FormatMetrics(metrics);
+        CHECK(output.find("window_switcher_populate_window_information_microseconds_bucket{le=\"1279\"} 1\n") != std::string::npos);
+        CHECK(output.find("\nwindow_switcher_populate_window_information_microseconds_bucket{le=\"+Inf\"} 1\n") != std::string::npos);
+        CHECK(output.find("\nwindow_switcher_populate_window_information_microseconds_sum 1234\n") != std::string::npos);
+        CHECK(output.find("\nwindow_switcher_populate_window_information_microseconds_count 1\n") != std::string::npos);
+        CHECK(output.find("\n# TYPE window_switcher_query_windows_microseconds histogram\n") != std::string::npos);
+        CHECK(output.find("\nwindow_switcher_windows_activated_total 1\n") != std::string::npos);
+
+        size_t line_start = 0;
+        while (line_start < output.size())
+        {
+            auto line_end = output.find('\n', line_start);
+            CHECK(line_end != std::string::npos);
+            auto line = output.substr(line_start, line_end - line_start);
+            bool is_type = line.compare(0, 23, "# TYPE window_switcher_") == 0 &&
+                (EndsWith(line, " counter") || EndsWith(line, " histogram"));
+            bool is_sample = line.compare(0, 16, "window_switcher_") == 0 && line.find(' ') != std::string::npos &&
+                line.find_first_not_of("0123456789", line.rfind(' ') + 1) == std::string::npos;
+            CHECK(is_type || is_sample);
+            if (line_end == std::string::npos)
+            {
+                break;
+            }
+            line_start = line_end + 1;
+        }
+    }
+
+    void TestSummaryFitsInTooltip()
+    {
+        static metrics_registry metrics;
+        RecordValue(metrics.hotkey_to_visible, UINT64_MAX);
+        RecordValue(metrics.query_windows, UINT64_MAX);
+        metrics.overlays_opened.value = UINT64_MAX;
+
+        // NOTIFYICONDATA::szTip holds 128 characters, including the terminating null. The summary is built in a
+        // buffer of that size, so check that nothing was cut rather than its length.
+        auto summary = FormatMetricsSummary(metrics);
+        CHECK(summary.size() < 128);
+        CHECK(EndsWith(summary, " opened"));
+        CHECK(summary.find("open p50 1.84e+13s p99 1.84e+13s\n") != std::string::npos);
+
+        static metrics_registry typical_metrics;
+        RecordValue(typical_metrics.hotkey_to_visible, 12500);
+        RecordValue(typical_metrics.query_windows, 250);
+        IncrementCounter(typical_metrics.overlays_opened);
+        CHECK_EQ(FormatMetricsSummary(typical_metrics),
+            std::string("window_switcher.exe\nopen p50 12.5ms p99 12.5ms\nquery p50 0.25ms p99 0.25ms\n1 opened"));
+    }
+}
+
+int main()
+{
+    TestBucketEdges();
+    TestPercentiles();
+    TestOverflowIsReportedAsInfinity();
+    TestConcurrentRecording();
+    TestExpositionFormat();
+    TestSummaryFitsInTooltip();
+    return ReportTestResult();
+}
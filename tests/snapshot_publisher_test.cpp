@@ -0,0 +1,162 @@
+#include "snapshot_publisher.h"
+
+#include "check.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+// Checks snapshot_publisher both deterministically and under a stress workload shaped like the switcher's:
+// a refresher publishing at 1 kHz while the UI reads at keystroke rate. Build with
+// -DWINDOW_SWITCHER_SANITIZER=thread to have ThreadSanitizer validate the reclamation.
+
+namespace
+{
+    std::atomic<int> g_live_snapshots{ 0 };
+
+    struct test_snapshot
+    {
+        explicit test_snapshot(uint64_t generation)
+            : generation(generation), values(64, generation)
+        {
+            ++g_live_snapshots;
+        }
+
+        ~test_snapshot()
+        {
+            --g_live_snapshots;
+        }
+
+        uint64_t generation;
+        std::vector<uint64_t> values;
+    };
+
+    bool IsConsistent(test_snapshot const& snapshot)
+    {
+        for (auto value : snapshot.values)
+        {
+            if (value != snapshot.generation)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void TestReadersKeepSnapshotsAlive()
+    {
+        {
+            snapshot_publisher<test_snapshot> publisher;
+            {
+                snapshot_read_guard<test_snapshot> empty(publisher);
+                CHECK(empty.get() == nullptr);
+            }
+
+            PublishSnapshot(publisher, std::unique_ptr<test_snapshot const>(new test_snapshot(1)));
+            {
+                snapshot_read_guard<test_snapshot> reader(publisher);
+                CHECK_EQ(reader->generation, uint64_t(1));
+
+                PublishSnapshot(publisher, std::unique_ptr<test_snapshot const>(new test_snapshot(2)));
+                PublishSnapshot(publisher, std::unique_ptr<test_snapshot const>(new test_snapshot(3)));
+
+                // The reader still sees generation 1, which is kept alive along with 2 (retired after it).
+                CHECK_EQ(reader->generation, uint64_t(1));
+                CHECK(IsConsistent(*reader.get()));
+                CHECK_EQ(g_live_snapshots.load(), 3);
+
+                snapshot_read_guard<test_snapshot> newer_reader(publisher);
+                CHECK_EQ(newer_reader->generation, uint64_t(3));
+            }
+
+            // Once the readers are gone, the next publication frees everything that was retired.
+            PublishSnapshot(publisher, std::unique_ptr<test_snapshot const>(new test_snapshot(4)));
+            CHECK_EQ(g_live_snapshots.load(), 1);
+            CHECK(publisher.retired.empty());
+        }
+        CHECK_EQ(g_live_snapshots.load(), 0);
+    }
+
+    void TestRefresherAgainstReaders(std::chrono::milliseconds duration)
+    {
+        {
+            snapshot_publisher<test_snapshot> publisher;
+            PublishSnapshot(publisher, std::unique_ptr<test_snapshot const>(new test_snapshot(0)));
+
+            std::atomic<bool> is_running{ true };
+            std::atomic<int> inconsistent_reads{ 0 };
+            std::atomic<uint64_t> read_count{ 0 };
+
+            // Background refresher, 1 kHz.
+            std::thread writer([&]
+            {
+                uint64_t generation = 1;
+                while (is_running.load())
+                {
+                    PublishSnapshot(publisher, std::unique_ptr<test_snapshot const>(new test_snapshot(generation++)));
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            });
+
+            // Readers: a few at keystroke rate holding the snapshot for a while like a query does,
+            // and one reading back to back to increase the chance of racing with the writer.
+            auto read = [&](std::chrono::microseconds pause, std::chrono::microseconds hold)
+            {
+                uint64_t last_generation = 0;
+                while (is_running.load())
+                {
+                    {
+                        snapshot_read_guard<test_snapshot> reader(publisher);
+                        if (!IsConsistent(*reader.get()) || reader->generation < last_generation)
+                        {
+                            ++inconsistent_reads;
+                        }
+                        last_generation = reader->generation;
+                        std::this_thread::sleep_for(hold);
+                        if (!IsConsistent(*reader.get()))
+                        {
+                            ++inconsistent_reads;
+                        }
+                    }
+                    ++read_count;
+                    std::this_thread::sleep_for(pause);
+                }
+            };
+
+            std::vector<std::thread> readers;
+            for (int i = 0; i < 3; ++i)
+            {
+                readers.emplace_back(read, std::chrono::milliseconds(50), std::chrono::milliseconds(2));
+            }
+            readers.emplace_back(read, std::chrono::microseconds(0), std::chrono::microseconds(0));
+
+            std::this_thread::sleep_for(duration);
+            is_running = false;
+            writer.join();
+            for (auto& reader : readers)
+            {
+                reader.join();
+            }
+
+            CHECK_EQ(inconsistent_reads.load(), 0);
+            CHECK(read_count.load() > 0);
+
+            // With no reader left, one more publication reclaims everything but the current snapshot.
+            PublishSnapshot(publisher, std::unique_ptr<test_snapshot const>(new test_snapshot(0)));
+            CHECK(publisher.retired.empty());
+            CHECK_EQ(g_live_snapshots.load(), 1);
+        }
+        CHECK_EQ(g_live_snapshots.load(), 0);
+    }
+}
+
+// Usage: snapshot_publisher_test [stress_duration_ms]
+int main(int argc, char** argv)
+{
+    auto duration = std::chrono::milliseconds(argc > 1 ? std::atoi(argv[1]) : 2000);
+    TestReadersKeepSnapshotsAlive();
+    TestRefresherAgainstReaders(duration);
+    return ReportTestResult();
+}
@@ -0,0 +1,280 @@
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "check.h"
+#include "fake_window_backend.h"
+#include "soak.h"
+
+namespace
+{
+    constexpr size_t c_ALLOCATION_HEADER_SIZE = alignof(std::max_align_t);
+    std::atomic<uint64_t> g_allocated_bytes{ 0 };
+}
+
+// Every allocation is prefixed with its size so that the deallocation can count it out.
+// All the replaceable forms are replaced, sanitizers would otherwise pair some of them with their own allocator.
+void* CountedAllocate(size_t size) noexcept
+{
+    auto block = static_cast<unsigned char*>(std::malloc(size + c_ALLOCATION_HEADER_SIZE));
+    if (!block)
+    {
+        return nullptr;
+    }
+    std::memcpy(block, &size, sizeof(size));
+    g_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    return block + c_ALLOCATION_HEADER_SIZE;
+}
+
+void CountedFree(void* pointer) noexcept
+{
+    if (!pointer)
+    {
+        return;
+    }
+    // Computed on the address: GCC sees pointer arithmetic before the start of the object and warns.
+    auto block = reinterpret_cast<unsigned char*>(reinterpret_cast<uintptr_t>(pointer) - c_ALLOCATION_HEADER_SIZE);
+    size_t size = 0;
+    std::memcpy(&size, block, sizeof(size));
+    g_allocated_bytes.fetch_sub(size, std::memory_order_relaxed);
+    std::free(block);
+}
+
+void* operator new(size_t size)
+{
+    if (auto pointer = CountedAllocate(size))
+    {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(size_t size, std::nothrow_t const&) noexcept
+{
+    return CountedAllocate(size);
+}
+
+void* operator new[](size_t size, std::nothrow_t const&) noexcept
+{
+    return CountedAllocate(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    CountedFree(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    CountedFree(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept
+{
+    CountedFree(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept
+{
+    CountedFree(pointer);
+}
+
+void operator delete(void* pointer, std::nothrow_t const&) noexcept
+{
+    CountedFree(pointer);
+}
+
+void operator delete[](void* pointer, std::nothrow_t const&) noexcept
+{
+    CountedFree(pointer);
+}
+
+uint64_t AllocatedBytes()
+{
+    return g_allocated_bytes.load(std::memory_order_relaxed);
+}
+
+std::vector<std::string> MakeWindowTitles()
+{
+    std::vector<std::string> titles = {
+        "outlook Inbox - someone@example.com",
+        "chrome New Tab",
+        "devenv window_switcher - Microsoft Visual Studio",
+        "Code main.cpp - window_switcher - Visual Studio Code",
+        "notepad++ readme.md",
+        "explorer Downloads",
+        "mspaint Untitled - Paint",
+        "WindowsTerminal PowerShell",
+    };
+    for (int i = 0; i < 32; ++i)
+    {
+        titles.push_back("chrome Search results " + std::to_string(i) + " - Google Chrome");
+    }
+    return titles;
+}
+
+resource_usage MakeSample(uint64_t handles)
+{
+    resource_usage usage;
+    usage.handles = handles;
+    return usage;
+}
+
+void TestParseSoakCommandLine()
+{
+    size_t cycle_count = 0;
+    CHECK(ParseSoakCommandLine("", cycle_count) == soak_mode::disabled);
+    CHECK(ParseSoakCommandLine("--soakfoo", cycle_count) == soak_mode::disabled);
+    CHECK(ParseSoakCommandLine("--soak5", cycle_count) == soak_mode::disabled);
+    CHECK(ParseSoakCommandLine("-soak", cycle_count) == soak_mode::disabled);
+
+    CHECK(ParseSoakCommandLine("--soak", cycle_count) == soak_mode::enabled);
+    CHECK_EQ(cycle_count, c_DEFAULT_SOAK_CYCLE_COUNT);
+    CHECK(ParseSoakCommandLine("--soak  ", cycle_count) == soak_mode::enabled);
+    CHECK_EQ(cycle_count, c_DEFAULT_SOAK_CYCLE_COUNT);
+    CHECK(ParseSoakCommandLine("--soak 5000", cycle_count) == soak_mode::enabled);
+    CHECK_EQ(cycle_count, size_t(5000));
+    CHECK(ParseSoakCommandLine("--soak 42 ", cycle_count) == soak_mode::enabled);
+    CHECK_EQ(cycle_count, size_t(42));
+
+    CHECK(ParseSoakCommandLine("--soak 0", cycle_count) == soak_mode::invalid_arguments);
+    CHECK(ParseSoakCommandLine("--soak -5", cycle_count) == soak_mode::invalid_arguments);
+    CHECK(ParseSoakCommandLine("--soak +5", cycle_count) == soak_mode::invalid_arguments);
+    CHECK(ParseSoakCommandLine("--soak 12abc", cycle_count) == soak_mode::invalid_arguments);
+    CHECK(ParseSoakCommandLine("--soak 1 2", cycle_count) == soak_mode::invalid_arguments);
+    CHECK(ParseSoakCommandLine("--soak 99999999999999999999999", cycle_count) == soak_mode::invalid_arguments);
+}
+
+void TestResourceGrowthDetection()
+{
+    std::vector<resource_usage> samples;
+    CHECK(!IsResourceGrowing(samples, &resource_usage::handles, 0));
+
+    // Flat with noise.
+    uint64_t const noisy[] = { 100, 103, 99, 101, 104, 98, 100, 102, 101, 99, 103, 100, 98, 102, 101, 100 };
+    for (auto handles : noisy)
+    {
+        samples.push_back(MakeSample(handles));
+    }
+    CHECK(!IsResourceGrowing(samples, &resource_usage::handles, 8));
+
+    // Leaks in bursts: plateaus between most samples, which growth between every pair of samples missed.
+    samples.clear();
+    uint64_t const staircase[] = { 100, 100, 100, 164, 164, 164, 164, 228, 228, 228, 228, 292, 292, 292, 292, 356 };
+    for (auto handles : staircase)
+    {
+        samples.push_back(MakeSample(handles));
+    }
+    CHECK(IsResourceGrowing(samples, &resource_usage::handles, 8));
+
+    // Growth within the tolerance, e.g. caches filling up.
+    samples.clear();
+    for (uint64_t i = 0; i < 16; ++i)
+    {
+        samples.push_back(MakeSample(100 + i / 2));
+    }
+    CHECK(!IsResourceGrowing(samples, &resource_usage::handles, 8));
+
+    // Slow steady leak.
+    samples.clear();
+    for (uint64_t i = 0; i < 16; ++i)
+    {
+        samples.push_back(MakeSample(100 + i * 3));
+    }
+    CHECK(IsResourceGrowing(samples, &resource_usage::handles, 8));
+}
+
+void TestWindowList()
+{
+    auto titles = MakeWindowTitles();
+    fake_window_backend backend(titles);
+    snapshot_publisher<window_snapshot> snapshots;
+    metrics_registry metrics;
+
+    OpenOverlay(backend, snapshots, metrics);
+    CHECK_EQ(backend.displayed_window_count, titles.size());
+    UpdateWindowList(backend, snapshots, metrics, "outlook");
+    CHECK_EQ(backend.displayed_window_count, size_t(1));
+    UpdateWindowList(backend, snapshots, metrics, "   ");
+    CHECK_EQ(backend.displayed_window_count, titles.size());
+
+    // A query that matches nothing shows nothing, rather than every window.
+    UpdateWindowList(backend, snapshots, metrics, "zzzz");
+    CHECK_EQ(backend.displayed_window_count, size_t(0));
+    backend.CloseOverlay();
+}
+
+void TestSoakWithoutLeaks(size_t cycle_count)
+{
+    fake_window_backend backend(MakeWindowTitles());
+    snapshot_publisher<window_snapshot> snapshots;
+    metrics_registry metrics;
+
+    CHECK(RunSoak(backend, snapshots, metrics, cycle_count, std::cout));
+
+    // Everything acquired during a cycle was released.
+    CHECK_EQ(backend.open_process_handles, uint64_t(0));
+    CHECK_EQ(backend.open_windows, uint64_t(0));
+    CHECK(!backend.has_thumbnail);
+    CHECK_EQ(backend.closed_overlay_count, cycle_count);
+    CHECK_EQ(metrics.overlays_opened.value.load(), uint64_t(cycle_count));
+    CHECK(metrics.query_windows.count.load() > cycle_count);
+}
+
+// The soak test must fail for every kind of leak, including ones that happen every few hundred cycles only.
+void TestSoakDetectsLeaks()
+{
+    constexpr size_t cycle_count = 4000;
+
+    fake_leaks leaky_configurations[7];
+    leaky_configurations[0].interval = 16;
+    leaky_configurations[0].process_handles = 1;
+    leaky_configurations[1].interval = 16;
+    leaky_configurations[1].windows = 1;
+    leaky_configurations[2].interval = 16;
+    leaky_configurations[2].thumbnails = 1;
+    leaky_configurations[3].interval = 16;
+    leaky_configurations[3].threads = 1;
+    leaky_configurations[4].interval = 16;
+    leaky_configurations[4].memory_bytes = 64 * 1024;
+    leaky_configurations[5].interval = 500;
+    leaky_configurations[5].process_handles = 64;
+    // A few hundred bytes every cycle: 1 MiB between the first and the last quarter, which a fixed 4 MiB allowance
+    // let through.
+    leaky_configurations[6].interval = 1;
+    leaky_configurations[6].memory_bytes = 512;
+
+    for (auto const& leaks : leaky_configurations)
+    {
+        fake_window_backend backend(MakeWindowTitles(), leaks);
+        snapshot_publisher<window_snapshot> snapshots;
+        metrics_registry metrics;
+        std::ostringstream log;
+        CHECK(!RunSoak(backend, snapshots, metrics, cycle_count, log));
+    }
+}
+
+// Usage: soak_test [cycle_count]. ctest runs a short soak, run it directly for the full one.
+int main(int argc, char** argv)
+{
+    size_t cycle_count = argc > 1 ? static_cast<size_t>(std::strtoull(argv[1], nullptr, 10)) : c_DEFAULT_SOAK_CYCLE_COUNT;
+
+    TestParseSoakCommandLine();
+    TestResourceGrowthDetection();
+    TestWindowList();
+    TestSoakWithoutLeaks(cycle_count);
+    TestSoakDetectsLeaks();
+    return ReportTestResult();
+}
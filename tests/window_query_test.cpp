@@ -0,0 +1,79 @@
+#include "window_query.h"
+
+#include "check.h"
+
+#include <string>
+#include <vector>
+
+namespace
+{
+    std::vector<window_process_info> MakeWindows()
+    {
+        std::vector<window_process_info> wpis;
+        wpis.emplace_back(nullptr, 1, "Inbox - Outlook", "outlook.exe");
+        wpis.emplace_back(nullptr, 2, "New Tab - Google Chrome", "chrome.exe");
+        wpis.emplace_back(nullptr, 3, "window_switcher - Microsoft Visual Studio", "devenv.exe");
+        wpis.emplace_back(nullptr, 4, "readme.md - Notepad++", "notepad++.exe");
+        wpis.emplace_back(nullptr, 5, "Untitled - Paint", "mspaint.exe");
+        return wpis;
+    }
+
+    std::vector<size_t> Query(std::string const& query, std::vector<window_process_info> const& wpis, bool allow_typos = true)
+    {
+        std::vector<size_t> matching_indices;
+        QueryWindows(query, wpis, matching_indices, allow_typos);
+        return matching_indices;
+    }
+
+    void TestExactMatches()
+    {
+        auto wpis = MakeWindows();
+        CHECK_EQ(Query("chrome", wpis), std::vector<size_t>({ 1 }));
+        CHECK_EQ(Query("CHROME", wpis), std::vector<size_t>({ 1 }));
+        CHECK_EQ(Query("devenv", wpis), std::vector<size_t>({ 2 }));
+        // Several words: a window matching any of them is listed once.
+        CHECK_EQ(Query("  outlook   chrome inbox ", wpis), std::vector<size_t>({ 0, 1 }));
+        CHECK(Query("", wpis).empty());
+        CHECK(Query("   ", wpis).empty());
+    }
+
+    void TestTypos()
+    {
+        auto wpis = MakeWindows();
+        CHECK_EQ(Query("outlok", wpis), std::vector<size_t>({ 0 }));
+        CHECK_EQ(Query("chrme", wpis), std::vector<size_t>({ 1 }));
+        CHECK_EQ(Query("visaul studio", wpis), std::vector<size_t>({ 2 }));
+        CHECK(Query("outlok", wpis, false).empty());
+        // Two letters swapped is a single typo.
+        CHECK_EQ(Query("chrmoe", wpis), std::vector<size_t>({ 1 }));
+        CHECK_EQ(Query("raedme", wpis), std::vector<size_t>({ 3 }));
+        CHECK_EQ(Query("otulook", wpis), std::vector<size_t>({ 0 }));
+        // Two typos in a short word are too many to match.
+        CHECK(Query("hcrmoe", wpis).empty());
+    }
+
+    void TestRanking()
+    {
+        std::vector<window_process_info> wpis;
+        wpis.emplace_back(nullptr, 1, "Pant settings", "settings.exe");      // One typo away from "paint".
+        wpis.emplace_back(nullptr, 2, "Spaint", "spaint.exe");               // Contains "paint" in the middle of a word.
+        wpis.emplace_back(nullptr, 3, "Untitled - Paint", "mspaint.exe");    // Contains "paint" at the start of a word.
+
+        // Exact matches first, word starts before the middle of words, then typos.
+        CHECK_EQ(Query("paint", wpis), std::vector<size_t>({ 2, 1, 0 }));
+        CHECK_EQ(Query("pant", wpis), std::vector<size_t>({ 0, 1, 2 }));
+
+        // A window keeps its best score across words: "spaint" is exact for the second window,
+        // which only had a typo match for "pant".
+        CHECK_EQ(Query("pant spaint", wpis), std::vector<size_t>({ 0, 1, 2 }));
+        CHECK_EQ(Query("paint pant", wpis), std::vector<size_t>({ 0, 2, 1 }));
+    }
+}
+
+int main()
+{
+    TestExactMatches();
+    TestTypos();
+    TestRanking();
+    return ReportTestResult();
+}
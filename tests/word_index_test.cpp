@@ -0,0 +1,105 @@
+#include "word_index.h"
+
+#include "check.h"
+
+#include <string>
+#include <vector>
+
+namespace
+{
+    // Words of an index, in text order.
+    std::vector<std::string> Words(word_index const& index)
+    {
+        std::vector<std::string> words;
+        for (size_t i = 0; i < index.word_starts.size(); ++i)
+        {
+            size_t end = index.word_starts[i] + 1;
+            while (end < index.lowercase_text.size() &&
+                (i + 1 == index.word_starts.size() || end < index.word_starts[i + 1]) &&
+                std::isalnum(static_cast<unsigned char>(index.lowercase_text[end])))
+            {
+                ++end;
+            }
+            words.push_back(index.lowercase_text.substr(index.word_starts[i], end - index.word_starts[i]));
+        }
+        return words;
+    }
+
+    void TestTokenization()
+    {
+        auto index = BuildWordIndex("Visual Studio Code");
+        CHECK_EQ(index.lowercase_text, std::string("visual studio code"));
+        CHECK_EQ(Words(index), std::vector<std::string>({ "visual", "studio", "code" }));
+        CHECK_EQ(index.acronym, std::string("vsc"));
+
+        // Separators: spaces, dashes, dots, path separators, @.
+        CHECK_EQ(Words(BuildWordIndex("readme.md - C:\\src\\main.cpp")),
+            std::vector<std::string>({ "readme", "md", "c", "src", "main", "cpp" }));
+        CHECK_EQ(BuildWordIndex("Inbox - someone@example.com - Outlook").acronym, std::string("iseco"));
+
+        // camelCase humps.
+        CHECK_EQ(Words(BuildWordIndex("windowSwitcher")), std::vector<std::string>({ "window", "switcher" }));
+        CHECK_EQ(Words(BuildWordIndex("PowerShell")), std::vector<std::string>({ "power", "shell" }));
+
+        // Every letter of an upper case run is a word.
+        CHECK_EQ(BuildWordIndex("VSCode").acronym, std::string("vsc"));
+        CHECK_EQ(Words(BuildWordIndex("VSCode")), std::vector<std::string>({ "v", "s", "code" }));
+        CHECK_EQ(BuildWordIndex("HTML Viewer").acronym, std::string("htmlv"));
+
+        // Letters and digits.
+        CHECK_EQ(Words(BuildWordIndex("notepad2")), std::vector<std::string>({ "notepad", "2" }));
+        CHECK_EQ(Words(BuildWordIndex("v141 2nd")), std::vector<std::string>({ "v", "141", "2", "nd" }));
+
+        // Nothing to index.
+        CHECK(BuildWordIndex("").word_starts.empty());
+        CHECK(BuildWordIndex(" - ").acronym.empty());
+    }
+
+    void TestWordPrefix()
+    {
+        auto index = BuildWordIndex("window_switcher - Microsoft Visual Studio");
+        CHECK(MatchesWordPrefix(index, "stu"));
+        CHECK(MatchesWordPrefix(index, "studio"));
+        CHECK(MatchesWordPrefix(index, "switch"));
+        CHECK(MatchesWordPrefix(index, "w"));
+        CHECK(MatchesWordPrefix(index, "visual studio"));
+        CHECK(!MatchesWordPrefix(index, "tudio"));
+        CHECK(!MatchesWordPrefix(index, "studios"));
+        CHECK(!MatchesWordPrefix(index, "x"));
+        CHECK(!MatchesWordPrefix(index, ""));
+
+        // Upper case runs.
+        auto vscode = BuildWordIndex("VSCode");
+        CHECK(MatchesWordPrefix(vscode, "code"));
+        CHECK(MatchesWordPrefix(vscode, "scode"));
+        CHECK(!MatchesWordPrefix(vscode, "ode"));
+    }
+
+    void TestAcronym()
+    {
+        auto index = BuildWordIndex("main.cpp - window_switcher - Visual Studio Code");
+        CHECK(MatchesAcronym(index, "vs"));
+        CHECK(MatchesAcronym(index, "vsc"));
+        CHECK(MatchesAcronym(index, "sc"));
+        CHECK(MatchesAcronym(index, "mc"));
+        CHECK(!MatchesAcronym(index, "v"));
+        CHECK(!MatchesAcronym(index, "vc"));
+        CHECK(!MatchesAcronym(index, "vscx"));
+
+        CHECK(MatchesAcronym(BuildWordIndex("VSCode"), "vsc"));
+        CHECK(MatchesAcronym(BuildWordIndex("VSCode"), "vs"));
+        CHECK(!MatchesAcronym(BuildWordIndex("VSCode"), "vc"));
+
+        // Acronyms only use word initials: "np" would need a match inside "notepad".
+        CHECK(MatchesAcronym(BuildWordIndex("notepad++ - readme"), "nr"));
+        CHECK(!MatchesAcronym(BuildWordIndex("notepad++ - readme"), "np"));
+    }
+}
+
+int main()
+{
+    TestTokenization();
+    TestWordPrefix();
+    TestAcronym();
+    return ReportTestResult();
+}
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <string>
+
+// Longest pattern supported by the bit-parallel matcher: one bit per pattern character.
+constexpr size_t c_MAX_APPROXIMATE_PATTERN_LENGTH = 64;
+
+// Highest number of edits tolerated in a query word, see MaxEditsForQueryLength.
+constexpr int c_MAX_APPROXIMATE_EDITS = 2;
+
+// Character masks of a pattern, built once per query and reused against every text.
+// Bit i of masks[c] is set when the i-th character of the pattern is c.
+struct bitap_pattern
+{
+    std::array<uint64_t, 256> masks = {};
+    size_t length = 0;
+};
+
+// Precond: pattern.size() <= c_MAX_APPROXIMATE_PATTERN_LENGTH.
+inline bitap_pattern BuildBitapPattern(std::string const& pattern)
+{
+    bitap_pattern result;
+    result.length = pattern.size();
+    for (size_t i = 0; i < pattern.size(); ++i)
+    {
+        result.masks[static_cast<unsigned char>(pattern[i])] |= uint64_t(1) << i;
+    }
+    return result;
+}
+
+// Finds the smallest number of edits (insertions, deletions, substitutions, swaps of two adjacent characters)
+// needed for the pattern to occur anywhere in text, using the Wu-Manber extension of the Bitap (shift-and)
+// algorithm with Hyyrö's transposition term. A swap counts as one edit, so "chrmoe" is one edit away from "chrome".
+// Returns -1 when more than max_edits edits are needed.
+// Precond: max_edits <= c_MAX_APPROXIMATE_EDITS.
+inline int ApproximateFind(bitap_pattern const& pattern, std::string const& text, int max_edits)
+{
+    if (pattern.length == 0)
+    {
+        return 0;
+    }
+    max_edits = (std::min)(max_edits, static_cast<int>(pattern.length) - 1);
+    if (max_edits < 0)
+    {
+        return -1;
+    }
+
+    // states[d] has bit i set when the first i+1 pattern characters match the text read so far,
+    // ending at the current character, with at most d edits.
+    uint64_t states[c_MAX_APPROXIMATE_EDITS + 1];
+    for (int d = 0; d <= max_edits; ++d)
+    {
+        states[d] = (uint64_t(1) << d) - 1;
+    }
+    // states as they were one character earlier, and the mask of that character, for transpositions.
+    uint64_t two_back_states[c_MAX_APPROXIMATE_EDITS + 1];
+    std::copy(states, states + max_edits + 1, two_back_states);
+    uint64_t previous_mask = 0;
+
+    uint64_t const found_bit = uint64_t(1) << (pattern.length - 1);
+    int best = -1;
+    for (char c : text)
+    {
+        uint64_t const mask = pattern.masks[static_cast<unsigned char>(c)];
+        uint64_t previous_old = states[0];
+        uint64_t previous_two_back = two_back_states[0];
+        two_back_states[0] = states[0];
+        states[0] = ((states[0] << 1) | 1) & mask;
+        for (int d = 1; d <= max_edits; ++d)
+        {
+            uint64_t const old = states[d];
+            states[d] = (((old << 1) | 1) & mask)                                 // Match.
+                | ((previous_old << 1) | 1)                                       // Substitution.
+                | ((states[d - 1] << 1) | 1)                                      // Deletion of a pattern character.
+                | previous_old                                                    // Insertion of a text character.
+                | (((((previous_two_back << 1) | 1) & mask) << 1) & previous_mask); // Transposition.
+            previous_old = old;
+            previous_two_back = two_back_states[d];
+            two_back_states[d] = old;
+        }
+        previous_mask = mask;
+
+        for (int d = 0; d <= max_edits; ++d)
+        {
+            if (states[d] & found_bit)
+            {
+                if (d == 0)
+                {
+                    return 0;
+                }
+                best = d;
+                // Nothing above the current best is worth tracking anymore.
+                max_edits = d - 1;
+                break;
+            }
+        }
+    }
+    return best;
+}
+
+// Number of edits tolerated for a query word. The matcher looks for the word anywhere in the text, so every
+// edit allowed makes a lot more texts match: short words would match almost anything if we allowed typos in them,
+// and a second typo is only allowed for words long enough to still be recognizable.
+inline int MaxEditsForQueryLength(size_t length)
+{
+    if (length < 3)
+    {
+        return 0;
+    }
+    if (length < 8)
+    {
+        return 1;
+    }
+    return c_MAX_APPROXIMATE_EDITS;
+}
+
+// Characters present in a text. Computed once per text to rule it out cheaply before running the matcher.
+using character_set = std::bitset<256>;
+
+inline character_set BuildCharacterSet(std::string const& text)
+{
+    character_set characters;
+    for (char c : text)
+    {
+        characters.set(static_cast<unsigned char>(c));
+    }
+    return characters;
+}
+
+// Pairs of consecutive characters present in a text, hashed. A pair missing from the set is certainly missing
+// from the text, a pair present in the set is probably in the text.
+using bigram_set = std::bitset<512>;
+
+inline size_t BigramHash(char first, char second)
+{
+    return (static_cast<unsigned char>(first) * 31u + static_cast<unsigned char>(second)) % 512u;
+}
+
+inline bigram_set BuildBigramSet(std::string const& text)
+{
+    bigram_set bigrams;
+    for (size_t i = 1; i < text.size(); ++i)
+    {
+        bigrams.set(BigramHash(text[i - 1], text[i]));
+    }
+    return bigrams;
+}
+
+// Returns true if the pattern might occur in text with at most max_edits edits.
+// If the pattern is cut in max_edits + 1 pieces, max_edits edits can't all fall inside different pieces: at least
+// one piece is untouched, except for its first character which a swap with the end of the previous piece may have
+// moved. Pieces are therefore searched without their first character, the first piece excepted.
+// text_bigrams rules out most pieces without searching the text.
+inline bool ContainsAnyPatternPiece(std::string const& pattern, std::string const& text, bigram_set const& text_bigrams, int max_edits)
+{
+    size_t const piece_count = static_cast<size_t>(max_edits) + 1;
+    size_t piece_start = 0;
+    for (size_t piece = 0; piece < piece_count; ++piece)
+    {
+        size_t piece_end = pattern.size() * (piece + 1) / piece_count;
+        if (piece > 0)
+        {
+            ++piece_start;
+        }
+        if (piece_start >= piece_end)
+        {
+            // Nothing left to look for: any text might match.
+            return true;
+        }
+        bool might_contain_piece = true;
+        for (size_t i = piece_start + 1; might_contain_piece && i < piece_end; ++i)
+        {
+            might_contain_piece = text_bigrams.test(BigramHash(pattern[i - 1], pattern[i]));
+        }
+        if (might_contain_piece && text.find(pattern.c_str() + piece_start, 0, piece_end - piece_start) != std::string::npos)
+        {
+            return true;
+        }
+        piece_start = piece_end;
+    }
+    return false;
+}
+
+// Returns true if the pattern might occur in a text made of text_characters with at most max_edits edits.
+// Every pattern character that appears nowhere in the text has to be substituted or deleted, so each one costs
+// at least an edit.
+inline bool MightMatchApproximately(std::string const& pattern, character_set const& text_characters, int max_edits)
+{
+    int missing_characters = 0;
+    for (char c : pattern)
+    {
+        if (!text_characters.test(static_cast<unsigned char>(c)) && ++missing_characters > max_edits)
+        {
+            return false;
+        }
+    }
+    return true;
+}
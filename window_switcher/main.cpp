@@ -2,6 +2,7 @@
 #include <Windowsx.h>
 #include <dwmapi.h>
 #include <memory>
+#include <atomic>
 #include <algorithm>
 #include <Psapi.h>
 #include <bitset>
@@ -13,6 +14,14 @@
 #include <cctype>
 #include <Shlwapi.h>
 #include <shellapi.h>
+#include <fstream>
+#include <TlHelp32.h>
+
+#include "metrics.h"
+#include "snapshot_publisher.h"
+#include "soak.h"
+#include "window_backend.h"
+#include "window_query.h"
 
 constexpr auto c_W_KEY = 0x5A;
 constexpr auto c_OVERLAY_WNDCLASS_NAME = "window_switcher_overlay_wndclass";
@@ -20,12 +29,22 @@ constexpr auto c_MIRROR_WNDCLASS_NAME = "window_switcher_mirror_wndclass";
 constexpr unsigned int c_NOTIFY_ICON_MESSAGE = WM_APP + 0x0001;
 constexpr unsigned int c_CLOSE_OVERLAY_WINDOW_MESSAGE = WM_APP + 0x0002;
 constexpr unsigned int c_MENU_ITEM_QUIT = 0x0001;
+constexpr unsigned int c_MENU_ITEM_DUMP_METRICS = 0x0002;
+constexpr auto c_METRICS_FILE_NAME = "window_switcher_metrics.txt";
+constexpr auto c_SOAK_FILE_NAME = "window_switcher_soak.csv";
 
 std::thread g_overlay_window_thread;
 HMENU g_notify_icon_context_menu = nullptr;
 
+// Performance metrics, recorded from every thread for the whole lifetime of the process.
+metrics_registry g_metrics;
+
 // Overlay window is the parent window invoked when pressing the main keyboard shortcut.
-HWND g_overlay_hwnd = nullptr;
+// Written by the overlay thread, read by the main thread when closing the overlay.
+std::atomic<HWND> g_overlay_hwnd{ nullptr };
+
+// The globals below belong to the overlay thread. Only one overlay thread runs at a time: the previous one
+// is joined before a new one starts.
 
 // Edit window, child of overlay window.
 HWND g_edit_hwnd = nullptr;
@@ -36,32 +55,34 @@ HWND g_list_box_hwnd = nullptr;
 // Mirror window, replicates the display of the currently selected item in List box. Child of overlay window.
 HWND g_mirror_hwnd = nullptr;
 
+// DWM thumbnail currently displayed in the mirror window. Unregistered when the overlay closes.
+HTHUMBNAIL g_mirror_thumbnail = nullptr;
+
 struct get_visible_windows_data
 {
-    std::vector<HWND> hwnds;
+    std::vector<window_handle> hwnds;
 };
 
-struct window_process_info
-{
-    window_process_info(
-        HWND hwnd,
-        DWORD pid,
-        std::string&& window_title,
-        std::string&& process_name)
-        : hwnd(hwnd),
-        pid(pid),
-        window_title(std::move(window_title)),
-        process_name(std::move(process_name))
-    {
-        static_assert(std::is_move_constructible<std::string>(), "");
-    }
+snapshot_publisher<window_snapshot> g_window_snapshots;
 
-    HWND hwnd = 0;
-    DWORD pid = 0;
-    std::string window_title;
-    std::string process_name;
+// Implements window_backend with the overlay globals above. Member functions are defined after the functions
+// they rely on, next to WinMain.
+struct win32_window_backend : window_backend
+{
+    std::vector<window_handle> GetVisibleWindows() override;
+    std::vector<window_process_info> PopulateWindowInformation(std::vector<window_handle> const& hwnds) override;
+    void CreateOverlay() override;
+    void DisplayWindowList(
+        std::vector<window_process_info> const& wpis,
+        std::vector<size_t> const& matching_indices,
+        bool is_query_empty) override;
+    void RegisterThumbnail(window_handle source) override;
+    void CloseOverlay() override;
+    resource_usage ReadResourceUsage() override;
 };
 
+win32_window_backend g_win32_backend;
+
 BOOL __stdcall EnumWindowsProc(HWND hwnd, LPARAM lparam)
 {
     auto& hwnds = reinterpret_cast<get_visible_windows_data*>(lparam)->hwnds;
@@ -80,7 +101,7 @@ BOOL __stdcall EnumWindowsProc(HWND hwnd, LPARAM lparam)
     return true;
 }
 
-std::vector<HWND> GetVisibleWindows()
+std::vector<window_handle> GetVisibleWindows()
 {
     get_visible_windows_data data;
     EnumWindows(EnumWindowsProc, reinterpret_cast<LPARAM>(&data));
@@ -88,21 +109,25 @@ std::vector<HWND> GetVisibleWindows()
 }
 
 // Reads the process id, name and the window title of several HWNDs.
-std::vector<window_process_info> PopulateWindowInformation(std::vector<HWND> const& hwnds)
+std::vector<window_process_info> PopulateWindowInformation(std::vector<window_handle> const& hwnds)
 {
     std::vector<window_process_info> wpis;
-    for (auto hwnd : hwnds)
+    for (auto handle : hwnds)
     {
+        auto hwnd = static_cast<HWND>(handle);
         char process_name[100] = { 0 };
         DWORD pid = 0;
         GetWindowThreadProcessId(hwnd, &pid);
         auto processHandle = OpenProcess(PROCESS_QUERY_INFORMATION, false, pid);
-        if (!GetProcessImageFileName(processHandle, process_name, static_cast<DWORD>(std::size(process_name))))
+        if (processHandle)
         {
-            // TODO(padib): handle errors
+            if (!GetProcessImageFileName(processHandle, process_name, static_cast<DWORD>(std::size(process_name))))
+            {
+                // TODO(padib): handle errors
+            }
+            CloseHandle(processHandle);
         }
         PTSTR filename = PathFindFileName(process_name);
-        CloseHandle(processHandle);
 
         char title[100] = { 0 };
         if (!GetWindowText(hwnd, title, static_cast<int>(std::size(title))))
@@ -115,68 +140,6 @@ std::vector<window_process_info> PopulateWindowInformation(std::vector<HWND> con
     return wpis;
 }
 
-// Match wpis against a single word query.
-std::vector<size_t> QueryWindows(std::string & query, std::vector<window_process_info> const & wpis)
-{
-    std::vector<size_t> matching_indices;
-    for (size_t i = 0; i < wpis.size(); ++i)
-    {
-        auto const& wpi = wpis[i];
-
-        // Make all the stuff lower case
-        auto window_title = wpi.window_title;
-        auto process_name = wpi.process_name;
-        std::transform(begin(window_title), end(window_title), begin(window_title), [](int c) { return static_cast<char>(std::tolower(c)); });
-        std::transform(begin(process_name), end(process_name), begin(process_name), [](int c) { return static_cast<char>(std::tolower(c)); });
-        std::transform(begin(query), end(query), begin(query), [](int c) { return static_cast<char>(std::tolower(c)); });
-
-        // find word in window title or process name
-        if (window_title.find(query) != std::string::npos || process_name.find(query) != std::string::npos)
-        {
-            matching_indices.push_back(i);
-        }
-    }
-    return matching_indices;
-}
-
-// Fill an array of indices that tells what elements of wpis match the user query.
-// Precond: 
-// - wholeQuery is a null-terminated string of space-separated words.
-// - matching_indices is empty
-// Postcond:
-// If idx is contained in matching_indices, it means that wpis[idx] matches the input wholeQuery.
-void QueryWindows(char* wholeQuery, std::vector<window_process_info> const& wpis, std::vector<size_t>& matching_indices)
-{
-    char* next_token = nullptr;
-    // Split query into words.
-    // Do a matching pass for each word.
-    auto token_ptr = strtok_s(wholeQuery, " ", &next_token);
-    if (token_ptr)
-    {
-        std::string token(token_ptr);
-        while (!token.empty())
-        {
-            auto indices = QueryWindows(token, wpis);
-            for (auto idx : indices)
-            {
-                if (std::find(begin(matching_indices), end(matching_indices), idx) == end(matching_indices))
-                {
-                    matching_indices.push_back(idx);
-                }
-            }
-            auto next = strtok_s(nullptr, " ", &next_token);
-            if (next)
-            {
-                token = std::string(next);
-            }
-            else
-            {
-                token.clear();
-            }
-        }
-    }
-}
-
 void RemoveNotifyIcon(NOTIFYICONDATA* p)
 {
     Shell_NotifyIcon(NIM_DELETE, p);
@@ -217,8 +180,46 @@ NotifyIconPtr CreateNotifyIcon(HWND message_window)
     return icon_data_ptr;
 }
 
+// Shows a summary of the metrics in the notify icon's tooltip.
+void UpdateNotifyIconTooltip(HWND message_window)
+{
+    NOTIFYICONDATA icon_data = {};
+    icon_data.cbSize = sizeof(NOTIFYICONDATA);
+    icon_data.uFlags = NIF_TIP | NIF_SHOWTIP;
+    icon_data.uID = 0;
+    icon_data.hWnd = message_window;
+    strncpy_s(icon_data.szTip, FormatMetricsSummary(g_metrics).c_str(), _TRUNCATE);
+    Shell_NotifyIcon(NIM_MODIFY, &icon_data);
+}
+
+// Writes all the metrics to a text file in the temp directory, and opens it.
+void DumpMetrics()
+{
+    char path[MAX_PATH] = { 0 };
+    if (!GetTempPath(static_cast<DWORD>(std::size(path)), path) || !PathAppend(path, c_METRICS_FILE_NAME))
+    {
+        return;
+    }
+
+    {
+        std::ofstream file(path, std::ios::trunc);
+        if (!file)
+        {
+            return;
+        }
+        file << FormatMetrics(g_metrics);
+    }
+
+    ShellExecute(nullptr, "open", path, nullptr, nullptr, SW_SHOWNORMAL);
+}
+
 void CloseOverlayWindowFromOwnThread()
 {
+    if (g_mirror_thumbnail)
+    {
+        DwmUnregisterThumbnail(g_mirror_thumbnail);
+        g_mirror_thumbnail = nullptr;
+    }
     DestroyWindow(g_overlay_hwnd);
     DestroyWindow(g_edit_hwnd);
     DestroyWindow(g_list_box_hwnd);
@@ -264,6 +265,7 @@ void SendCurrentlySelectedWindowToForeground()
             SendMessage(target_hwnd, WM_SYSCOMMAND, SC_RESTORE, 0);
         }
         SetForegroundWindow(target_hwnd);
+        IncrementCounter(g_metrics.windows_activated);
     }
 }
 
@@ -336,17 +338,15 @@ void AddItemToListBox(HWND list_box_hwnd, window_process_info const & wpi)
     ListBox_SetItemData(list_box_hwnd, list_item, (LPVOID)wpi.hwnd);
 }
 
-void ClearAndDisplayWindowList(HWND list_box_hwnd, char * query)
+void DisplayWindowList(
+    HWND list_box_hwnd,
+    std::vector<window_process_info> const& wpis,
+    std::vector<size_t> const& matching_indices,
+    bool is_query_empty)
 {
-    // Populate the list box
-    auto hwnds = GetVisibleWindows();
-    auto wpis = PopulateWindowInformation(hwnds);
-
-    std::vector<size_t> matching_indices;
-    QueryWindows(query, wpis, matching_indices);
-
     ListBox_ResetContent(list_box_hwnd);
-    if (matching_indices.empty())
+    // A query that matches nothing shows an empty list, only an empty query shows every window.
+    if (is_query_empty)
     {
         for (auto const & wpi : wpis)
         {
@@ -372,7 +372,7 @@ void ClearAndDisplayWindowList(HWND list_box_hwnd, char * query)
     // We got an empty query. In that case, we start by selecting the second item
     // in the list. This enables a behavior similar to Alt-Tab (focusing the most
     // recently active window).
-    if (query[0] == 0)
+    if (is_query_empty)
     {
         initial_selection_index = 1;
     }
@@ -380,6 +380,66 @@ void ClearAndDisplayWindowList(HWND list_box_hwnd, char * query)
     ListBox_SetCurSel(list_box_hwnd, initial_selection_index);
 }
 
+// Displays a thumbnail of source_hwnd in mirror_hwnd, replacing the previous one.
+void RegisterMirrorThumbnail(HWND mirror_hwnd, HWND source_hwnd)
+{
+    // Get destination rectangle by scaling the source rectangle to the 
+    // current window client rect.
+    RECT source_rect;
+    GetWindowRect(source_hwnd, &source_rect);
+    RECT available_rect;
+    GetClientRect(mirror_hwnd, &available_rect);
+    float width_ratio = static_cast<float>(available_rect.right - available_rect.left) / static_cast<float>(source_rect.right - source_rect.left);
+    float height_ratio = static_cast<float>(available_rect.bottom - available_rect.top) / static_cast<float>(source_rect.bottom - source_rect.top);
+
+    // Choose the lowest ratio (choosing the highest won't fit the other dimension in the dest window).
+    float ratio = min(width_ratio, height_ratio);
+
+    RECT dest_rect = available_rect;
+    // TODO(padib): This is a poor detection for minimized window. Minimized's windows thumbnails 
+    // don't have the same ratio as the maximized version. Current workaround is to use all |available_rect|
+    // instead of computing |dest_rect| based on the ratio.
+    // A better workaround would be to scale the minimized window using the screen's aspect ratio (or better, find
+    // the non-minimized window ratio).
+    if (ratio < 3.f)
+    {
+        // If we don't have to reduce the source window size then keep the original window size.
+        ratio = min(ratio, 1.f);
+
+        // Fit the destination rectangle in the available rectangle so that it is centered.
+        int needed_width = static_cast<int>((source_rect.right - source_rect.left) * ratio);
+        int needed_height = static_cast<int>((source_rect.bottom - source_rect.top) * ratio);
+        dest_rect.left = ((available_rect.right - available_rect.left) - needed_width) / 2;
+        dest_rect.right = dest_rect.left + needed_width;
+        dest_rect.top = ((available_rect.bottom - available_rect.top) - needed_height) / 2;
+        dest_rect.bottom = dest_rect.top + needed_height;
+    }
+
+    if (g_mirror_thumbnail)
+    {
+        DwmUnregisterThumbnail(g_mirror_thumbnail);
+        g_mirror_thumbnail = nullptr;
+    }
+
+    // Register and update the thumbnail using Desktop Window Manager APIs.
+    // This allows us to display a thumbnail of source_hwnd in mirror_hwnd, 
+    // just like the ALT+TAB window does.
+    auto register_start = std::chrono::steady_clock::now();
+    if (SUCCEEDED(DwmRegisterThumbnail(mirror_hwnd, source_hwnd, &g_mirror_thumbnail)))
+    {
+        // Set the thumbnail properties for use
+        DWM_THUMBNAIL_PROPERTIES thumbnail_properties;
+        thumbnail_properties.dwFlags = DWM_TNP_SOURCECLIENTAREAONLY | DWM_TNP_VISIBLE | DWM_TNP_RECTDESTINATION;
+        thumbnail_properties.fSourceClientAreaOnly = FALSE;
+        thumbnail_properties.fVisible = TRUE;
+        thumbnail_properties.rcDestination = dest_rect;
+
+        // Display the thumbnail
+        DwmUpdateThumbnailProperties(g_mirror_thumbnail, &thumbnail_properties);
+    }
+    RecordLatency(g_metrics.thumbnail_register, register_start);
+}
+
 LRESULT MirrorWindowProc(
     _In_ HWND hWnd,
     _In_ UINT msg,
@@ -395,62 +455,7 @@ LRESULT MirrorWindowProc(
         static auto s_brush = CreateSolidBrush(RGB(0, 0, 0));
         FillRect(paint_struct.hdc, &paint_struct.rcPaint, s_brush);
 
-        auto source_hwnd = GetCurrentlySelectedHwnd();
-
-        // Get destination rectangle by scaling the source rectangle to the 
-        // current window client rect.
-        RECT source_rect;
-        GetWindowRect(source_hwnd, &source_rect);
-        RECT available_rect;
-        GetClientRect(hWnd, &available_rect);
-        float width_ratio = static_cast<float>(available_rect.right - available_rect.left) / static_cast<float>(source_rect.right - source_rect.left);
-        float height_ratio = static_cast<float>(available_rect.bottom - available_rect.top) / static_cast<float>(source_rect.bottom - source_rect.top);
-
-        // Choose the lowest ratio (choosing the highest won't fit the other dimension in the dest window).
-        float ratio = min(width_ratio, height_ratio);
-
-        RECT dest_rect = available_rect;
-        // TODO(padib): This is a poor detection for minimized window. Minimized's windows thumbnails 
-        // don't have the same ratio as the maximized version. Current workaround is to use all |available_rect|
-        // instead of computing |dest_rect| based on the ratio.
-        // A better workaround would be to scale the minimized window using the screen's aspect ratio (or better, find
-        // the non-minimized window ratio).
-        if (ratio < 3.f)
-        {
-            // If we don't have to reduce the source window size then keep the original window size.
-            ratio = min(ratio, 1.f);
-
-            // Fit the destination rectangle in the available rectangle so that it is centered.
-            int needed_width = static_cast<int>((source_rect.right - source_rect.left) * ratio);
-            int needed_height = static_cast<int>((source_rect.bottom - source_rect.top) * ratio);
-            dest_rect.left = ((available_rect.right - available_rect.left) - needed_width) / 2;
-            dest_rect.right = dest_rect.left + needed_width;
-            dest_rect.top = ((available_rect.bottom - available_rect.top) - needed_height) / 2;
-            dest_rect.bottom = dest_rect.top + needed_height;
-        }
-
-        static HTHUMBNAIL thumbnail_id = NULL;
-
-        if (thumbnail_id)
-        {
-            DwmUnregisterThumbnail(thumbnail_id);
-        }
-
-        // Register and update the thumbnail using Desktop Window Manager APIs.
-        // This allows us to display a thumbnail of the currently selected HWND in g_mirror_hwnd, 
-        // just like the ALT+TAB window does.
-        if (SUCCEEDED(DwmRegisterThumbnail(hWnd, source_hwnd, &thumbnail_id)))
-        {
-            // Set the thumbnail properties for use
-            DWM_THUMBNAIL_PROPERTIES thumbnail_properties;
-            thumbnail_properties.dwFlags = DWM_TNP_SOURCECLIENTAREAONLY | DWM_TNP_VISIBLE | DWM_TNP_RECTDESTINATION;
-            thumbnail_properties.fSourceClientAreaOnly = FALSE;
-            thumbnail_properties.fVisible = TRUE;
-            thumbnail_properties.rcDestination = dest_rect;
-
-            // Display the thumbnail
-            DwmUpdateThumbnailProperties(thumbnail_id, &thumbnail_properties);
-        }
+        RegisterMirrorThumbnail(hWnd, GetCurrentlySelectedHwnd());
 
         EndPaint(hWnd, &paint_struct);
     } break;
@@ -482,7 +487,7 @@ LRESULT OverlayWindowProc(
                 char input[100];
                 ZeroMemory(input, std::size(input));
                 Edit_GetText(g_edit_hwnd, input, static_cast<int>(std::size(input)));
-                ClearAndDisplayWindowList(g_list_box_hwnd, input);
+                UpdateWindowList(g_win32_backend, g_window_snapshots, g_metrics, input);
             } break;
             default:
             {
@@ -599,9 +604,6 @@ void CreateOverlayWindow()
 
     SetForegroundWindow(g_edit_hwnd);
     SetFocus(g_edit_hwnd);
-
-    char query[] = "";
-    ClearAndDisplayWindowList(g_list_box_hwnd, query);
 }
 
 LRESULT MessageWindowProc(
@@ -614,22 +616,24 @@ LRESULT MessageWindowProc(
     {
         if (HIWORD(lParam) == c_W_KEY && LOWORD(lParam) == (MOD_WIN | MOD_ALT))
         {
+            auto hotkey_time = std::chrono::steady_clock::now();
             SendCloseOverlayWindowMessage();
 
-            auto endlife_thread = std::move(g_overlay_window_thread);
+            // Wait for the wind down of the previous overlay, if any, before creating a new one.
+            // Both overlay threads would otherwise use the overlay globals (g_edit_hwnd, g_list_box_hwnd,
+            // g_mirror_hwnd, g_mirror_thumbnail) at the same time.
+            if (g_overlay_window_thread.joinable())
+            {
+                g_overlay_window_thread.join();
+            }
 
-            g_overlay_window_thread = std::thread([]
+            g_overlay_window_thread = std::thread([hotkey_time]
             {
-                CreateOverlayWindow();
+                OpenOverlay(g_win32_backend, g_window_snapshots, g_metrics);
+                RecordLatency(g_metrics.hotkey_to_visible, hotkey_time);
                 RunOverlayWindowThreadLoop();
             });
 
-            // We just created a new window, we should wait for the wind down of the previous one if any.
-            if (endlife_thread.joinable())
-            {
-                endlife_thread.join();
-            }
-
             return 0;
         }
     }
@@ -653,6 +657,12 @@ LRESULT MessageWindowProc(
 
             return 0;
         }
+        else if (LOWORD(lParam) == WM_MOUSEMOVE)
+        {
+            // The mouse is over the icon, refresh the tooltip before it shows up.
+            UpdateNotifyIconTooltip(hWnd);
+            return 0;
+        }
     }
     else if (msg == WM_COMMAND)
     {
@@ -664,6 +674,10 @@ LRESULT MessageWindowProc(
                 // Exit the application. Will exit the message loop.
                 PostQuitMessage(0);
             }
+            else if (LOWORD(wParam) == c_MENU_ITEM_DUMP_METRICS)
+            {
+                DumpMetrics();
+            }
         }
         return DefWindowProc(hWnd, msg, wParam, lParam);
     }
@@ -675,10 +689,110 @@ LRESULT MessageWindowProc(
     return 0;
 }
 
+DWORD CountCurrentProcessThreads()
+{
+    DWORD thread_count = 0;
+    auto snapshot_handle = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
+    if (snapshot_handle == INVALID_HANDLE_VALUE)
+    {
+        return 0;
+    }
+
+    THREADENTRY32 entry = {};
+    entry.dwSize = sizeof(THREADENTRY32);
+    auto pid = GetCurrentProcessId();
+    for (auto found = Thread32First(snapshot_handle, &entry); found; found = Thread32Next(snapshot_handle, &entry))
+    {
+        if (entry.th32OwnerProcessID == pid)
+        {
+            ++thread_count;
+        }
+    }
+    CloseHandle(snapshot_handle);
+    return thread_count;
+}
+
+std::vector<window_handle> win32_window_backend::GetVisibleWindows()
+{
+    return ::GetVisibleWindows();
+}
+
+std::vector<window_process_info> win32_window_backend::PopulateWindowInformation(std::vector<window_handle> const& hwnds)
+{
+    return ::PopulateWindowInformation(hwnds);
+}
+
+void win32_window_backend::CreateOverlay()
+{
+    CreateOverlayWindow();
+}
+
+void win32_window_backend::DisplayWindowList(
+    std::vector<window_process_info> const& wpis,
+    std::vector<size_t> const& matching_indices,
+    bool is_query_empty)
+{
+    ::DisplayWindowList(g_list_box_hwnd, wpis, matching_indices, is_query_empty);
+}
+
+void win32_window_backend::RegisterThumbnail(window_handle source)
+{
+    RegisterMirrorThumbnail(g_mirror_hwnd, static_cast<HWND>(source));
+}
+
+// Closes the overlay through its message loop, like a key press would. This also handles the messages that
+// were queued while the overlay was open.
+void win32_window_backend::CloseOverlay()
+{
+    PostMessage(g_overlay_hwnd, c_CLOSE_OVERLAY_WINDOW_MESSAGE, 0 /*wParam*/, 0 /*lParam*/);
+    RunOverlayWindowThreadLoop();
+}
+
+resource_usage win32_window_backend::ReadResourceUsage()
+{
+    resource_usage usage;
+    auto process = GetCurrentProcess();
+    usage.gui_objects = GetGuiResources(process, GR_GDIOBJECTS) + GetGuiResources(process, GR_USEROBJECTS);
+    DWORD handle_count = 0;
+    GetProcessHandleCount(process, &handle_count);
+    usage.handles = handle_count;
+    usage.threads = CountCurrentProcessThreads();
+
+    PROCESS_MEMORY_COUNTERS_EX memory_counters = {};
+    memory_counters.cb = sizeof(memory_counters);
+    if (GetProcessMemoryInfo(process, reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&memory_counters), sizeof(memory_counters)))
+    {
+        usage.memory_bytes = memory_counters.PrivateUsage;
+    }
+    return usage;
+}
+
+// Soak test mode, started with `window_switcher.exe --soak [cycle_count]`. See soak.h.
+// Samples are written to window_switcher_soak.csv in the temp directory. Returns a non-zero exit code if the
+// process leaked.
+int RunSoakTest(size_t cycle_count)
+{
+    char path[MAX_PATH] = { 0 };
+    if (!GetTempPath(static_cast<DWORD>(std::size(path)), path) || !PathAppend(path, c_SOAK_FILE_NAME))
+    {
+        return ERROR_PATH_NOT_FOUND;
+    }
+
+    std::ofstream log(path, std::ios::trunc);
+    if (!log)
+    {
+        return ERROR_OPEN_FAILED;
+    }
+
+    bool passed = RunSoak(g_win32_backend, g_window_snapshots, g_metrics, cycle_count, log);
+    OutputDebugString(passed ? "Soak test passed.\n" : "Soak test failed, see window_switcher_soak.csv.\n");
+    return passed ? 0 : 1;
+}
+
 int __stdcall WinMain(
     HINSTANCE hInstance,
     HINSTANCE /*hPrevInstance*/,
-    LPSTR /*lpCmdLine*/,
+    LPSTR lpCmdLine,
     int /*nCmdShow*/)
 {
     WNDCLASSEX message_wnd_class = {};
@@ -714,7 +828,27 @@ int __stdcall WinMain(
         return GetLastError();
     }
 
+    size_t soak_cycle_count = 0;
+    switch (ParseSoakCommandLine(lpCmdLine, soak_cycle_count))
+    {
+    case soak_mode::enabled:
+        return RunSoakTest(soak_cycle_count);
+    case soak_mode::invalid_arguments:
+        return ERROR_INVALID_PARAMETER;
+    case soak_mode::disabled:
+        break;
+    }
+
     g_notify_icon_context_menu = CreatePopupMenu();
+    if (!AppendMenu(
+        g_notify_icon_context_menu,
+        MF_STRING | MF_ENABLED,
+        c_MENU_ITEM_DUMP_METRICS /*uIDNewItem*/,
+        "Dump metrics"))
+    {
+        return GetLastError();
+    }
+
     if (!AppendMenu(
         g_notify_icon_context_menu,
         MF_STRING | MF_ENABLED,
@@ -760,4 +894,4 @@ int __stdcall WinMain(
     }
 
     return 0;
-}
\ No newline at end of file
+}
\ No newline at end of file
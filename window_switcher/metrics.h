@@ -0,0 +1,264 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// Always-on performance metrics. Recording is lock-free: every value is a relaxed atomic increment,
+// so any thread can record at any time and readers only ever see slightly stale numbers.
+
+struct metrics_counter
+{
+    std::atomic<uint64_t> value{ 0 };
+};
+
+inline void IncrementCounter(metrics_counter& counter)
+{
+    counter.value.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Histogram with log-linear buckets, in the spirit of HdrHistogram: values below c_HISTOGRAM_SUB_BUCKETS get
+// a bucket each, then every power of two is split into c_HISTOGRAM_SUB_BUCKETS buckets. This keeps about 12%
+// precision from 0 up to 2^c_HISTOGRAM_MAX_EXPONENT - 1 with a fixed amount of memory.
+// Larger values all land in a final overflow bucket, which is reported as +Inf.
+constexpr unsigned c_HISTOGRAM_SUB_BUCKET_BITS = 3;
+constexpr uint64_t c_HISTOGRAM_SUB_BUCKETS = uint64_t(1) << c_HISTOGRAM_SUB_BUCKET_BITS;
+constexpr unsigned c_HISTOGRAM_MAX_EXPONENT = 40;
+constexpr size_t c_HISTOGRAM_OVERFLOW_BUCKET = c_HISTOGRAM_SUB_BUCKETS * (c_HISTOGRAM_MAX_EXPONENT - c_HISTOGRAM_SUB_BUCKET_BITS + 1);
+constexpr size_t c_HISTOGRAM_BUCKET_COUNT = c_HISTOGRAM_OVERFLOW_BUCKET + 1;
+
+struct histogram
+{
+    std::atomic<uint64_t> buckets[c_HISTOGRAM_BUCKET_COUNT] = {};
+    std::atomic<uint64_t> count{ 0 };
+    std::atomic<uint64_t> sum{ 0 };
+    std::atomic<uint64_t> max_value{ 0 };
+};
+
+inline unsigned HighestBitIndex(uint64_t value)
+{
+    unsigned index = 0;
+    for (unsigned shift = 32; shift > 0; shift /= 2)
+    {
+        if (value >> shift)
+        {
+            value >>= shift;
+            index += shift;
+        }
+    }
+    return index;
+}
+
+inline size_t HistogramBucketIndex(uint64_t value)
+{
+    if (value < c_HISTOGRAM_SUB_BUCKETS)
+    {
+        return static_cast<size_t>(value);
+    }
+    unsigned exponent = HighestBitIndex(value);
+    if (exponent >= c_HISTOGRAM_MAX_EXPONENT)
+    {
+        return c_HISTOGRAM_OVERFLOW_BUCKET;
+    }
+    unsigned shift = exponent - c_HISTOGRAM_SUB_BUCKET_BITS;
+    uint64_t sub_bucket = (value >> shift) - c_HISTOGRAM_SUB_BUCKETS;
+    return static_cast<size_t>(c_HISTOGRAM_SUB_BUCKETS * (shift + 1) + sub_bucket);
+}
+
+// Largest value stored in a bucket. The overflow bucket has no upper bound.
+inline uint64_t HistogramBucketUpperBound(size_t bucket_index)
+{
+    if (bucket_index >= c_HISTOGRAM_OVERFLOW_BUCKET)
+    {
+        return UINT64_MAX;
+    }
+    if (bucket_index < c_HISTOGRAM_SUB_BUCKETS)
+    {
+        return bucket_index;
+    }
+    uint64_t shift = bucket_index / c_HISTOGRAM_SUB_BUCKETS - 1;
+    uint64_t sub_bucket = bucket_index % c_HISTOGRAM_SUB_BUCKETS;
+    return ((c_HISTOGRAM_SUB_BUCKETS + sub_bucket + 1) << shift) - 1;
+}
+
+inline void RecordValue(histogram& h, uint64_t value)
+{
+    h.buckets[HistogramBucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    h.count.fetch_add(1, std::memory_order_relaxed);
+    h.sum.fetch_add(value, std::memory_order_relaxed);
+    auto current_max = h.max_value.load(std::memory_order_relaxed);
+    while (value > current_max && !h.max_value.compare_exchange_weak(current_max, value, std::memory_order_relaxed))
+    {
+    }
+}
+
+// Latencies are recorded in microseconds.
+inline void RecordLatency(histogram& h, std::chrono::steady_clock::time_point start)
+{
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    RecordValue(h, static_cast<uint64_t>(elapsed.count()));
+}
+
+// Records the time spent in the enclosing scope.
+struct scoped_latency_timer
+{
+    explicit scoped_latency_timer(histogram& h)
+        : h(h), start(std::chrono::steady_clock::now())
+    {
+    }
+
+    ~scoped_latency_timer()
+    {
+        RecordLatency(h, start);
+    }
+
+    scoped_latency_timer(scoped_latency_timer const&) = delete;
+    scoped_latency_timer& operator=(scoped_latency_timer const&) = delete;
+
+    histogram& h;
+    std::chrono::steady_clock::time_point start;
+};
+
+// Upper bound of the value below which `percentile` percent of the recorded values fall. 0 if nothing was recorded.
+inline uint64_t HistogramPercentile(histogram const& h, double percentile)
+{
+    uint64_t count = 0;
+    for (auto const& bucket : h.buckets)
+    {
+        count += bucket.load(std::memory_order_relaxed);
+    }
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    auto rank = static_cast<uint64_t>(percentile / 100.0 * static_cast<double>(count) + 0.5);
+    rank = rank == 0 ? 1 : rank;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < c_HISTOGRAM_BUCKET_COUNT; ++i)
+    {
+        seen += h.buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank)
+        {
+            auto recorded_max = h.max_value.load(std::memory_order_relaxed);
+            auto upper_bound = HistogramBucketUpperBound(i);
+            return upper_bound < recorded_max ? upper_bound : recorded_max;
+        }
+    }
+    return h.max_value.load(std::memory_order_relaxed);
+}
+
+struct metrics_registry
+{
+    // Latencies, in microseconds.
+    histogram hotkey_to_visible;
+    histogram enumerate_windows;
+    histogram populate_window_information;
+    histogram query_windows;
+    histogram thumbnail_register;
+
+    // Number of windows in each snapshot.
+    histogram windows_per_snapshot;
+
+    metrics_counter overlays_opened;
+    metrics_counter windows_activated;
+};
+
+// Appends "window_switcher_<name><suffix> <value>". Lines are built on the string directly: metric names are
+// long enough that a fixed size buffer would cut some of them.
+inline void AppendSample(std::string& output, char const* name, std::string const& suffix, uint64_t value)
+{
+    output += "window_switcher_";
+    output += name;
+    output += suffix;
+    output += ' ';
+    output += std::to_string(value);
+    output += '\n';
+}
+
+inline void AppendType(std::string& output, char const* name, char const* type)
+{
+    output += "# TYPE window_switcher_";
+    output += name;
+    output += ' ';
+    output += type;
+    output += '\n';
+}
+
+inline void AppendCounter(std::string& output, char const* name, metrics_counter const& counter)
+{
+    AppendType(output, name, "counter");
+    AppendSample(output, name, "", counter.value.load(std::memory_order_relaxed));
+}
+
+inline void AppendHistogram(std::string& output, char const* name, histogram const& h)
+{
+    AppendType(output, name, "histogram");
+
+    // Buckets are cumulative, empty ones are skipped to keep the output short.
+    // The overflow bucket is only counted in the +Inf line.
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < c_HISTOGRAM_BUCKET_COUNT; ++i)
+    {
+        auto bucket_count = h.buckets[i].load(std::memory_order_relaxed);
+        if (bucket_count == 0)
+        {
+            continue;
+        }
+        cumulative += bucket_count;
+        if (i == c_HISTOGRAM_OVERFLOW_BUCKET)
+        {
+            break;
+        }
+        AppendSample(output, name, "_bucket{le=\"" + std::to_string(HistogramBucketUpperBound(i)) + "\"}", cumulative);
+    }
+    AppendSample(output, name, "_bucket{le=\"+Inf\"}", cumulative);
+    AppendSample(output, name, "_sum", h.sum.load(std::memory_order_relaxed));
+    AppendSample(output, name, "_count", h.count.load(std::memory_order_relaxed));
+}
+
+// Dumps every metric in the Prometheus text exposition format.
+inline std::string FormatMetrics(metrics_registry const& metrics)
+{
+    std::string output;
+    AppendHistogram(output, "hotkey_to_visible_microseconds", metrics.hotkey_to_visible);
+    AppendHistogram(output, "enumerate_windows_microseconds", metrics.enumerate_windows);
+    AppendHistogram(output, "populate_window_information_microseconds", metrics.populate_window_information);
+    AppendHistogram(output, "query_windows_microseconds", metrics.query_windows);
+    AppendHistogram(output, "thumbnail_register_microseconds", metrics.thumbnail_register);
+    AppendHistogram(output, "windows_per_snapshot", metrics.windows_per_snapshot);
+    AppendCounter(output, "overlays_opened_total", metrics.overlays_opened);
+    AppendCounter(output, "windows_activated_total", metrics.windows_activated);
+    return output;
+}
+
+// Latency in microseconds, with 3 significant digits so that even absurd values stay short: "0.25ms", "12.5ms",
+// "1.5s", "1.84e+13s".
+inline std::string FormatShortLatency(uint64_t microseconds)
+{
+    char text[32];
+    if (microseconds < 1000000)
+    {
+        snprintf(text, sizeof(text), "%.3gms", microseconds / 1000.0);
+    }
+    else
+    {
+        snprintf(text, sizeof(text), "%.3gs", microseconds / 1000000.0);
+    }
+    return text;
+}
+
+// A few lines short enough to fit in a notify icon tooltip (128 characters, including the terminating null).
+inline std::string FormatMetricsSummary(metrics_registry const& metrics)
+{
+    char summary[128];
+    snprintf(summary, sizeof(summary), "window_switcher.exe\nopen p50 %s p99 %s\nquery p50 %s p99 %s\n%llu opened",
+        FormatShortLatency(HistogramPercentile(metrics.hotkey_to_visible, 50)).c_str(),
+        FormatShortLatency(HistogramPercentile(metrics.hotkey_to_visible, 99)).c_str(),
+        FormatShortLatency(HistogramPercentile(metrics.query_windows, 50)).c_str(),
+        FormatShortLatency(HistogramPercentile(metrics.query_windows, 99)).c_str(),
+        static_cast<unsigned long long>(metrics.overlays_opened.value.load(std::memory_order_relaxed)));
+    return summary;
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Publishes immutable snapshots from writer threads to reader threads, RCU style.
+//
+// The current snapshot is a plain atomic pointer. Writers swap in a new snapshot and retire the previous one,
+// readers load the pointer and use the snapshot in place. A retired snapshot is deleted once every reader that
+// could have loaded it is done with it: before loading the pointer, readers announce the current epoch in a
+// slot, and a snapshot retired at epoch e is only freed when no slot holds an epoch lower than or equal to e.
+//
+// Readers never wait on writers nor on each other: reading is one CAS per slot tried, one load, and one store
+// to release. With at most c_MAX_SNAPSHOT_READERS concurrent readers a free slot always exists, so reads are
+// wait-free. Writers are serialized by a mutex, which readers never take.
+
+constexpr size_t c_MAX_SNAPSHOT_READERS = 16;
+
+template <typename T>
+struct snapshot_publisher
+{
+    struct retired_snapshot
+    {
+        T const* snapshot;
+        uint64_t epoch;
+    };
+
+    snapshot_publisher() = default;
+    snapshot_publisher(snapshot_publisher const&) = delete;
+    snapshot_publisher& operator=(snapshot_publisher const&) = delete;
+
+    // Precond: no reader is active.
+    ~snapshot_publisher()
+    {
+        delete current.load();
+        for (auto const& retired_entry : retired)
+        {
+            delete retired_entry.snapshot;
+        }
+    }
+
+    std::atomic<T const*> current{ nullptr };
+
+    // Incremented every time a snapshot is retired.
+    std::atomic<uint64_t> epoch{ 1 };
+
+    // Epoch announced by each active reader, 0 when the slot is free.
+    std::atomic<uint64_t> reader_epochs[c_MAX_SNAPSHOT_READERS] = {};
+
+    // Only touched by writers, under writer_mutex.
+    std::mutex writer_mutex;
+    std::vector<retired_snapshot> retired;
+};
+
+// Deletes the retired snapshots that no reader can be using anymore.
+// Precond: publisher.writer_mutex is held.
+template <typename T>
+void ReclaimRetiredSnapshots(snapshot_publisher<T>& publisher)
+{
+    uint64_t oldest_reader_epoch = UINT64_MAX;
+    for (auto const& reader_epoch : publisher.reader_epochs)
+    {
+        auto value = reader_epoch.load();
+        if (value != 0 && value < oldest_reader_epoch)
+        {
+            oldest_reader_epoch = value;
+        }
+    }
+
+    auto& retired = publisher.retired;
+    size_t kept = 0;
+    for (size_t i = 0; i < retired.size(); ++i)
+    {
+        if (retired[i].epoch < oldest_reader_epoch)
+        {
+            delete retired[i].snapshot;
+        }
+        else
+        {
+            retired[kept++] = retired[i];
+        }
+    }
+    retired.resize(kept);
+}
+
+// Replaces the current snapshot. The previous one stays alive until the readers using it are done.
+template <typename T>
+void PublishSnapshot(snapshot_publisher<T>& publisher, std::unique_ptr<T const> snapshot)
+{
+    std::lock_guard<std::mutex> lock(publisher.writer_mutex);
+    auto previous = publisher.current.exchange(snapshot.release());
+    if (previous)
+    {
+        // Readers that loaded |previous| announced an epoch no greater than the one returned here.
+        publisher.retired.push_back({ previous, publisher.epoch.fetch_add(1) });
+    }
+    ReclaimRetiredSnapshots(publisher);
+}
+
+// Gives access to the current snapshot for as long as the guard lives. The snapshot seen through a guard never
+// changes, even if a newer one gets published in the meantime.
+template <typename T>
+struct snapshot_read_guard
+{
+    explicit snapshot_read_guard(snapshot_publisher<T>& publisher)
+        : publisher(publisher)
+    {
+        // Only loops more than once if more than c_MAX_SNAPSHOT_READERS readers are active at the same time.
+        for (;;)
+        {
+            for (size_t i = 0; i < c_MAX_SNAPSHOT_READERS; ++i)
+            {
+                uint64_t free_slot = 0;
+                if (publisher.reader_epochs[i].compare_exchange_strong(free_slot, publisher.epoch.load()))
+                {
+                    slot_index = i;
+                    snapshot = publisher.current.load();
+                    return;
+                }
+            }
+        }
+    }
+
+    ~snapshot_read_guard()
+    {
+        publisher.reader_epochs[slot_index].store(0);
+    }
+
+    snapshot_read_guard(snapshot_read_guard const&) = delete;
+    snapshot_read_guard& operator=(snapshot_read_guard const&) = delete;
+
+    // nullptr if nothing was published yet.
+    T const* get() const
+    {
+        return snapshot;
+    }
+
+    T const* operator->() const
+    {
+        return snapshot;
+    }
+
+    snapshot_publisher<T>& publisher;
+    size_t slot_index = 0;
+    T const* snapshot = nullptr;
+};
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "metrics.h"
+#include "snapshot_publisher.h"
+#include "window_backend.h"
+
+// Soak test: plays what a user does with the overlay many times in a row, and checks that the resources held by
+// the process stop growing once the first cycles are done.
+
+constexpr size_t c_DEFAULT_SOAK_CYCLE_COUNT = 1000000;
+constexpr size_t c_SOAK_SAMPLE_COUNT = 16;
+
+enum class soak_mode
+{
+    disabled,
+    enabled,
+    invalid_arguments,
+};
+
+// Parses `--soak [cycle_count]`. Anything else, "--soakfoo" included, leaves the soak test disabled.
+inline soak_mode ParseSoakCommandLine(char const* command_line, size_t& cycle_count)
+{
+    static char const soak_switch[] = "--soak";
+    size_t const soak_switch_length = sizeof(soak_switch) - 1;
+    if (std::strncmp(command_line, soak_switch, soak_switch_length) != 0 ||
+        (command_line[soak_switch_length] != 0 && command_line[soak_switch_length] != ' '))
+    {
+        return soak_mode::disabled;
+    }
+
+    char const* arguments = command_line + soak_switch_length;
+    while (*arguments == ' ')
+    {
+        ++arguments;
+    }
+    if (*arguments == 0)
+    {
+        cycle_count = c_DEFAULT_SOAK_CYCLE_COUNT;
+        return soak_mode::enabled;
+    }
+
+    // strtoull accepts signs and leading spaces, only plain digits are valid here.
+    char* arguments_end = nullptr;
+    auto parsed_cycle_count = std::isdigit(static_cast<unsigned char>(*arguments)) ? std::strtoull(arguments, &arguments_end, 10) : 0;
+    while (arguments_end && *arguments_end == ' ')
+    {
+        ++arguments_end;
+    }
+    if (parsed_cycle_count == 0 || parsed_cycle_count == ULLONG_MAX || *arguments_end != 0)
+    {
+        return soak_mode::invalid_arguments;
+    }
+    cycle_count = static_cast<size_t>(parsed_cycle_count);
+    return soak_mode::enabled;
+}
+
+// A resource leaks when every sample of the last quarter of the run is above every sample of the first quarter
+// by more than the tolerance. Leaks show up even when usage plateaus between samples, and noise doesn't.
+inline bool IsResourceGrowing(std::vector<resource_usage> const& samples, uint64_t resource_usage::* resource, uint64_t tolerance)
+{
+    size_t const quarter = samples.size() / 4;
+    if (quarter == 0)
+    {
+        return false;
+    }
+
+    uint64_t first_quarter_max = 0;
+    for (size_t i = 0; i < quarter; ++i)
+    {
+        first_quarter_max = (std::max)(first_quarter_max, samples[i].*resource);
+    }
+    uint64_t last_quarter_min = UINT64_MAX;
+    for (size_t i = samples.size() - quarter; i < samples.size(); ++i)
+    {
+        last_quarter_min = (std::min)(last_quarter_min, samples[i].*resource);
+    }
+    return last_quarter_min > first_quarter_max + tolerance;
+}
+
+// Opens the overlay, types the query one character at a time, moves the selection down twice and back up, and
+// closes the overlay.
+inline void RunSoakCycle(
+    window_backend& backend,
+    snapshot_publisher<window_snapshot>& snapshots,
+    metrics_registry& metrics,
+    std::string const& query)
+{
+    OpenOverlay(backend, snapshots, metrics);
+    for (size_t length = 1; length <= query.size(); ++length)
+    {
+        UpdateWindowList(backend, snapshots, metrics, query.substr(0, length));
+    }
+
+    {
+        snapshot_read_guard<window_snapshot> snapshot(snapshots);
+        size_t const selections[] = { 1, 2, 1 };
+        for (auto selection : selections)
+        {
+            if (selection < snapshot->wpis.size())
+            {
+                backend.RegisterThumbnail(snapshot->wpis[selection].hwnd);
+            }
+        }
+    }
+
+    backend.CloseOverlay();
+}
+
+// Runs cycle_count cycles, each on a new overlay thread like the hotkey does, and writes resource usage samples
+// to log as CSV. Returns false if any resource kept growing over the run.
+inline bool RunSoak(
+    window_backend& backend,
+    snapshot_publisher<window_snapshot>& snapshots,
+    metrics_registry& metrics,
+    size_t cycle_count,
+    std::ostream& log)
+{
+    static char const* const queries[] = { "", "chrome", "chrmoe", "outlok", "visual studio", "np" };
+
+    // Let lazily allocated resources (window classes internals, CRT buffers, ...) settle before the first sample.
+    size_t const warmup_cycles = (std::min)(cycle_count / 10, size_t(1000));
+    size_t const sample_interval = (std::max)((cycle_count - warmup_cycles) / c_SOAK_SAMPLE_COUNT, size_t(1));
+
+    log << "cycle,memory_bytes,handles,gui_objects,threads\n";
+    std::vector<resource_usage> samples;
+    for (size_t cycle = 0; cycle < cycle_count; ++cycle)
+    {
+        std::string query = queries[cycle % (sizeof(queries) / sizeof(queries[0]))];
+        std::thread overlay_thread([&]
+        {
+            RunSoakCycle(backend, snapshots, metrics, query);
+        });
+        overlay_thread.join();
+
+        if (cycle >= warmup_cycles && (cycle - warmup_cycles) % sample_interval == 0)
+        {
+            samples.push_back(backend.ReadResourceUsage());
+            auto const& usage = samples.back();
+            log << cycle << ',' << usage.memory_bytes << ',' << usage.handles << ',' << usage.gui_objects << ',' << usage.threads << std::endl;
+        }
+    }
+
+    // Growth allowed between the first and the last quarter of the samples: a fixed allowance for caches filling
+    // up, plus a budget per cycle run in between so that a small leak fails short runs as well as long ones.
+    struct resource_tolerance
+    {
+        char const* name;
+        uint64_t resource_usage::* resource;
+        uint64_t tolerance;
+        uint64_t tolerance_per_cycle;
+    };
+    static resource_tolerance const tolerances[] = {
+        { "memory_bytes", &resource_usage::memory_bytes, 512 << 10, 16 },
+        { "handles", &resource_usage::handles, 16, 0 },
+        { "gui_objects", &resource_usage::gui_objects, 16, 0 },
+        { "threads", &resource_usage::threads, 2, 0 },
+    };
+
+    // Cycles between the last sample of the first quarter and the first sample of the last quarter.
+    size_t const quarter = samples.size() / 4;
+    uint64_t const cycles_between_quarters = quarter == 0 ? 0 : (samples.size() - 2 * quarter + 1) * sample_interval;
+
+    bool passed = true;
+    for (auto const& tolerance : tolerances)
+    {
+        uint64_t const allowed_growth = tolerance.tolerance + tolerance.tolerance_per_cycle * cycles_between_quarters;
+        if (IsResourceGrowing(samples, tolerance.resource, allowed_growth))
+        {
+            log << "Soak test failed: " << tolerance.name << " kept growing.\n";
+            passed = false;
+        }
+    }
+    if (passed)
+    {
+        log << "Soak test passed.\n";
+    }
+    log.flush();
+    return passed;
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "metrics.h"
+#include "snapshot_publisher.h"
+#include "window_query.h"
+
+// Resources held by the process, as reported by a window_backend.
+struct resource_usage
+{
+    // Private bytes on Windows.
+    uint64_t memory_bytes = 0;
+    // Kernel handles: processes, threads, files, ...
+    uint64_t handles = 0;
+    // Windows, thumbnails and drawing objects. GDI plus USER objects on Windows.
+    uint64_t gui_objects = 0;
+    uint64_t threads = 0;
+};
+
+// Everything window_switcher asks from the platform. The Win32 implementation lives in main.cpp, tests use a fake.
+// Overlay calls are made from the overlay thread: the thread that called CreateOverlay owns the overlay until it
+// calls CloseOverlay.
+struct window_backend
+{
+    virtual ~window_backend() = default;
+
+    // Top level windows the user can switch to, most recently active first.
+    virtual std::vector<window_handle> GetVisibleWindows() = 0;
+
+    // Reads the process id, name and the window title of several windows.
+    virtual std::vector<window_process_info> PopulateWindowInformation(std::vector<window_handle> const& hwnds) = 0;
+
+    virtual void CreateOverlay() = 0;
+
+    // Shows wpis[matching_indices[0]], wpis[matching_indices[1]], ... or every window when the query is empty.
+    virtual void DisplayWindowList(
+        std::vector<window_process_info> const& wpis,
+        std::vector<size_t> const& matching_indices,
+        bool is_query_empty) = 0;
+
+    // Mirrors the given window in the overlay, replacing the previous thumbnail.
+    virtual void RegisterThumbnail(window_handle source) = 0;
+
+    // Releases everything CreateOverlay and RegisterThumbnail acquired.
+    virtual void CloseOverlay() = 0;
+
+    virtual resource_usage ReadResourceUsage() = 0;
+};
+
+// Immutable list of windows taken at a given point in time.
+// A snapshot is never modified once published, see snapshot_publisher.h. This lets a refresher build the next
+// snapshot on any thread while queries keep reading the current one without waiting.
+struct window_snapshot
+{
+    std::vector<window_process_info> wpis;
+};
+
+inline std::unique_ptr<window_snapshot const> BuildWindowSnapshot(window_backend& backend, metrics_registry& metrics)
+{
+    auto snapshot = std::make_unique<window_snapshot>();
+    std::vector<window_handle> hwnds;
+    {
+        scoped_latency_timer timer(metrics.enumerate_windows);
+        hwnds = backend.GetVisibleWindows();
+    }
+    {
+        scoped_latency_timer timer(metrics.populate_window_information);
+        snapshot->wpis = backend.PopulateWindowInformation(hwnds);
+    }
+    RecordValue(metrics.windows_per_snapshot, snapshot->wpis.size());
+    return snapshot;
+}
+
+// Runs the query against the current snapshot and displays the windows that match. Typing doesn't enumerate
+// windows again.
+inline void UpdateWindowList(
+    window_backend& backend,
+    snapshot_publisher<window_snapshot>& snapshots,
+    metrics_registry& metrics,
+    std::string const& query)
+{
+    if (!snapshots.current.load())
+    {
+        PublishSnapshot(snapshots, BuildWindowSnapshot(backend, metrics));
+    }
+    snapshot_read_guard<window_snapshot> snapshot(snapshots);
+
+    std::vector<size_t> matching_indices;
+    {
+        scoped_latency_timer timer(metrics.query_windows);
+        QueryWindows(query, snapshot->wpis, matching_indices);
+    }
+    // A query made of spaces only has no words, it lists every window like an empty one.
+    bool is_query_empty = query.find_first_not_of(' ') == std::string::npos;
+    backend.DisplayWindowList(snapshot->wpis, matching_indices, is_query_empty);
+}
+
+// What pressing the hotkey does, on the new overlay thread.
+inline void OpenOverlay(window_backend& backend, snapshot_publisher<window_snapshot>& snapshots, metrics_registry& metrics)
+{
+    IncrementCounter(metrics.overlays_opened);
+    backend.CreateOverlay();
+
+    // Take a fresh snapshot every time the overlay is shown, queries typed afterwards will read from it.
+    PublishSnapshot(snapshots, BuildWindowSnapshot(backend, metrics));
+    UpdateWindowList(backend, snapshots, metrics, "");
+}
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "approximate_match.h"
+#include "word_index.h"
+
+// Opaque platform window handle: an HWND on Windows.
+using window_handle = void*;
+
+struct window_process_info
+{
+    window_process_info(
+        window_handle hwnd,
+        uint32_t pid,
+        std::string&& window_title,
+        std::string&& process_name)
+        : hwnd(hwnd),
+        pid(pid),
+        window_title(std::move(window_title)),
+        process_name(std::move(process_name)),
+        window_title_index(BuildWordIndex(this->window_title)),
+        process_name_index(BuildWordIndex(this->process_name)),
+        window_title_characters(BuildCharacterSet(window_title_index.lowercase_text)),
+        process_name_characters(BuildCharacterSet(process_name_index.lowercase_text)),
+        window_title_bigrams(BuildBigramSet(window_title_index.lowercase_text)),
+        process_name_bigrams(BuildBigramSet(process_name_index.lowercase_text))
+    {
+        static_assert(std::is_move_constructible<std::string>(), "");
+    }
+
+    window_handle hwnd = nullptr;
+    uint32_t pid = 0;
+    std::string window_title;
+    std::string process_name;
+
+    // Lower case text, word starts and acronyms, computed once per snapshot rather than on every keystroke.
+    word_index window_title_index;
+    word_index process_name_index;
+
+    // Let typo-tolerant matching skip texts that can't match before running the matcher.
+    character_set window_title_characters;
+    character_set process_name_characters;
+    bigram_set window_title_bigrams;
+    bigram_set process_name_bigrams;
+};
+
+struct window_match
+{
+    size_t index = 0;
+    // Number of typos needed for the query to match this window. 0 for exact matches.
+    int edits = 0;
+    // Whether the query matched the start of a word or the initials of words, rather than the middle of a word.
+    bool at_word_start = false;
+};
+
+// Orders matches from most to least relevant.
+inline bool IsBetterMatch(window_match const& a, window_match const& b)
+{
+    if (a.edits != b.edits)
+    {
+        return a.edits < b.edits;
+    }
+    return a.at_word_start && !b.at_word_start;
+}
+
+// Smallest number of edits needed for the query to occur in text, or -1 if more than max_edits are needed.
+inline int ApproximateFindInText(
+    bitap_pattern const& pattern,
+    std::string const& query,
+    std::string const& text,
+    character_set const& text_characters,
+    bigram_set const& text_bigrams,
+    int max_edits)
+{
+    // Cheap filters first: most texts are ruled out without running the matcher.
+    if (max_edits <= 0 ||
+        !MightMatchApproximately(query, text_characters, max_edits) ||
+        !ContainsAnyPatternPiece(query, text, text_bigrams, max_edits))
+    {
+        return -1;
+    }
+    return ApproximateFind(pattern, text, max_edits);
+}
+
+// Match wpis against a single word query.
+// Windows containing the word, or whose word initials contain it, are exact matches. When allow_typos is set,
+// others match if the word is found in their title or process name with a few typos, as long as the query is
+// short enough for the bit-parallel matcher.
+inline std::vector<window_match> QueryWindows(std::string & query, std::vector<window_process_info> const & wpis, bool allow_typos)
+{
+    std::transform(begin(query), end(query), begin(query), [](int c) { return static_cast<char>(std::tolower(c)); });
+
+    int max_edits = 0;
+    bitap_pattern pattern;
+    if (allow_typos && query.size() <= c_MAX_APPROXIMATE_PATTERN_LENGTH)
+    {
+        max_edits = MaxEditsForQueryLength(query.size());
+        pattern = BuildBitapPattern(query);
+    }
+
+    std::vector<window_match> matches;
+    for (size_t i = 0; i < wpis.size(); ++i)
+    {
+        auto const& wpi = wpis[i];
+
+        auto const& window_title = wpi.window_title_index.lowercase_text;
+        auto const& process_name = wpi.process_name_index.lowercase_text;
+
+        // Word starts and acronyms are looked up in the precomputed indices.
+        bool at_word_start =
+            MatchesWordPrefix(wpi.window_title_index, query) ||
+            MatchesWordPrefix(wpi.process_name_index, query) ||
+            MatchesAcronym(wpi.window_title_index, query) ||
+            MatchesAcronym(wpi.process_name_index, query);
+
+        // find word in window title or process name
+        if (at_word_start || window_title.find(query) != std::string::npos || process_name.find(query) != std::string::npos)
+        {
+            matches.push_back({ i, 0, at_word_start });
+        }
+        else if (max_edits > 0)
+        {
+            // The process name only needs to be scanned if it could beat the title.
+            auto edits = ApproximateFindInText(pattern, query, window_title, wpi.window_title_characters, wpi.window_title_bigrams, max_edits);
+            auto process_max_edits = edits > 0 ? edits - 1 : max_edits;
+            auto process_edits = ApproximateFindInText(pattern, query, process_name, wpi.process_name_characters, wpi.process_name_bigrams, process_max_edits);
+            if (process_edits > 0)
+            {
+                edits = process_edits;
+            }
+            if (edits > 0)
+            {
+                matches.push_back({ i, edits, false });
+            }
+        }
+    }
+    return matches;
+}
+
+// Fill an array of indices that tells what elements of wpis match the user query.
+// Precond: 
+// - wholeQuery is a string of space-separated words.
+// - matching_indices is empty
+// Postcond:
+// If idx is contained in matching_indices, it means that wpis[idx] matches the input wholeQuery.
+// Indices are ordered by number of typos, so exact matches come first, then by whether words start with the query.
+inline void QueryWindows(
+    std::string const& wholeQuery,
+    std::vector<window_process_info> const& wpis,
+    std::vector<size_t>& matching_indices,
+    bool allow_typos = true)
+{
+    std::vector<window_match> matches;
+    // Position of each window in |matches|, or -1 if it didn't match any word yet.
+    std::vector<ptrdiff_t> match_positions(wpis.size(), -1);
+
+    // Split query into words.
+    // Do a matching pass for each word.
+    size_t token_start = wholeQuery.find_first_not_of(' ');
+    while (token_start != std::string::npos)
+    {
+        auto token_end = wholeQuery.find(' ', token_start);
+        auto token = wholeQuery.substr(token_start, token_end == std::string::npos ? std::string::npos : token_end - token_start);
+        for (auto const& match : QueryWindows(token, wpis, allow_typos))
+        {
+            auto& position = match_positions[match.index];
+            if (position < 0)
+            {
+                position = static_cast<ptrdiff_t>(matches.size());
+                matches.push_back(match);
+            }
+            else if (IsBetterMatch(match, matches[position]))
+            {
+                // Keep the best match across all words.
+                matches[position] = match;
+            }
+        }
+        token_start = token_end == std::string::npos ? token_end : wholeQuery.find_first_not_of(' ', token_end);
+    }
+
+    std::stable_sort(begin(matches), end(matches), IsBetterMatch);
+    for (auto const& match : matches)
+    {
+        matching_indices.push_back(match.index);
+    }
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cctype>
+#include <string>
+#include <vector>
+
+// Word boundaries of a window title or process name, computed once when the window information is read so that
+// queries don't have to detect them on every keystroke.
+// Words are separated by any non alphanumeric character (" - ", path separators, dots, ...), and also start at a
+// camelCase hump ("windowSwitcher") or where letters and digits meet ("notepad2", "v141"). Every letter of an
+// upper case run is a word of its own, so that "VSCode" gives the acronym "vsc" like "Visual Studio Code" does.
+struct word_index
+{
+    // Lower case copy of the indexed text.
+    std::string lowercase_text;
+
+    // Offset in lowercase_text of the first character of every word.
+    std::vector<size_t> word_starts;
+
+    // First character of every word, lower case. "Visual Studio Code" gives "vsc".
+    std::string acronym;
+};
+
+// Returns true if a word starts at text[i].
+inline bool IsWordStart(std::string const& text, size_t i)
+{
+    auto is_alnum = [](unsigned char c) { return std::isalnum(c) != 0; };
+    auto is_upper = [](unsigned char c) { return std::isupper(c) != 0; };
+    auto is_lower = [](unsigned char c) { return std::islower(c) != 0; };
+    auto is_digit = [](unsigned char c) { return std::isdigit(c) != 0; };
+
+    auto c = static_cast<unsigned char>(text[i]);
+    if (!is_alnum(c))
+    {
+        return false;
+    }
+    if (i == 0 || !is_alnum(static_cast<unsigned char>(text[i - 1])))
+    {
+        return true;
+    }
+
+    auto previous = static_cast<unsigned char>(text[i - 1]);
+
+    // "camelCase": upper case letter right after a lower case one.
+    bool camel_hump = is_upper(c) && is_lower(previous);
+    // "VSCode", "HTML": every letter of an upper case run.
+    bool upper_case_run = is_upper(c) && is_upper(previous);
+    // "notepad2", "2nd": transition between letters and digits.
+    bool digit_transition = is_digit(c) != is_digit(previous);
+
+    return camel_hump || upper_case_run || digit_transition;
+}
+
+inline word_index BuildWordIndex(std::string const& text)
+{
+    word_index index;
+    index.lowercase_text.reserve(text.size());
+
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        index.lowercase_text.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(text[i]))));
+        if (IsWordStart(text, i))
+        {
+            index.word_starts.push_back(i);
+            index.acronym.push_back(index.lowercase_text.back());
+        }
+    }
+    return index;
+}
+
+// Returns true if lowercase_query is the beginning of one of the indexed words. "stu" matches "Visual Studio".
+// Titles only have a handful of words: a scan is as fast as a binary search over sorted suffixes, without
+// having to sort them for every window of every snapshot.
+inline bool MatchesWordPrefix(word_index const& index, std::string const& lowercase_query)
+{
+    if (lowercase_query.empty())
+    {
+        return false;
+    }
+    for (auto word_start : index.word_starts)
+    {
+        if (index.lowercase_text.compare(word_start, lowercase_query.size(), lowercase_query) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Returns true if lowercase_query is made of the initials of consecutive words. "vs" matches "Visual Studio Code".
+inline bool MatchesAcronym(word_index const& index, std::string const& lowercase_query)
+{
+    return lowercase_query.size() > 1 && index.acronym.find(lowercase_query) != std::string::npos;
+}